@@ -0,0 +1,71 @@
+//
+//  AlignedAllocator.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef AlignedAllocator_hpp
+#define AlignedAllocator_hpp
+
+#include <cstddef>
+#include <new>
+#include <stdlib.h>
+
+/**
+ * Allocator returning storage aligned to Alignment bytes (a power of 2 and a
+ * multiple of sizeof(void*)), so that vector kernels can work on whole cache
+ * lines. Used as the allocator of the Pulse sample storage.
+ */
+
+template <class T, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() {}
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t n)
+    {
+        if (n == 0)
+            return nullptr;
+        void* p = nullptr;
+        if (posix_memalign(&p, Alignment, n * sizeof(T)) != 0)
+            throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        free(p);
+    }
+};
+
+template <class T, class U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return true;
+}
+
+template <class T, class U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return false;
+}
+
+#endif /* AlignedAllocator_hpp */
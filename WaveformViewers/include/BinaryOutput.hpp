@@ -68,6 +68,7 @@ public:
     void doWriteGlobal(EBGlobal* theGlobalSummary = NULL);
     void doPrepareEvent();
     void doWriteData(POD& theEBDataPOD, const int& DCID);
+    void doWriteData(const PODArena& thePODs);
     void doWriteEvent(EBEvent& theEBEvent);
 
 protected:
@@ -85,6 +86,7 @@ protected:
     };
 
     std::vector<DataCollector> DC;
+    std::vector<std::vector<char>> DCBuffer; //Event data per DC, reused
 
     /**
      * Explanation of this structure is useful here.
@@ -26,6 +26,10 @@ public:
     void add(const TYPE val);
     unsigned long distance(const int fst, const int snd);
 
+    // Access by absolute position i, which is wrapped around the buffer
+    TYPE& operator[](const unsigned long long i);
+    unsigned long size() const;
+
 protected:
     unsigned long SIZE;
 
@@ -97,4 +101,16 @@ unsigned long Buffer<TYPE>::distance(const int fst,
     return (a < b) ? a : b;
 }
 
+template <class TYPE>
+TYPE& Buffer<TYPE>::operator[](const unsigned long long i)
+{
+    return buf[i % SIZE];
+}
+
+template <class TYPE>
+unsigned long Buffer<TYPE>::size() const
+{
+    return SIZE;
+}
+
 #endif /* Buffer_hpp */
@@ -0,0 +1,66 @@
+//
+//  ColouredNoise.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef ColouredNoise_hpp
+#define ColouredNoise_hpp
+
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FFT.hpp"
+#include "GaussianNoise.hpp"
+
+/**
+ * Generator of coloured (correlated) noise following a measured power
+ * spectral density.
+ *
+ * The noise is synthesised once in the frequency domain: complex Gaussian
+ * amplitudes are weighted by sqrt(PSD) and transformed back with FFT. The
+ * resulting periodic block is kept as a bank and fill() copies slices of
+ * it starting at random offsets, so that realistic noise costs a copy per
+ * pulse rather than a filter per sample.
+ *
+ * PSD tables are one-sided, with frequencies in [Hz] and densities in
+ * [mV^2/Hz]. They are read from text files with one row per point:
+ *
+ *     channel  frequency  PSD
+ *
+ * Rows with channel -1 define the spectrum used by channels that have no
+ * spectrum of their own. Lines starting with # are ignored.
+ */
+
+class ColouredNoise
+{
+public:
+    typedef std::vector<std::pair<double, double>> Spectrum;
+
+    ColouredNoise();
+    ColouredNoise(const Spectrum& psd, const double& samplePeriod_ns, const size_t& bankSize);
+    ~ColouredNoise();
+
+    static std::map<int, Spectrum> readPSDFile(const std::string& path);
+
+    void fill(std::vector<double>& noise, const size_t& n);
+    void startSequence(const size_t& n);
+    void fillNext(std::vector<double>& noise, const size_t& n);
+    double getRMS() const;
+    size_t getBankSize() const;
+
+private:
+    double interpolatePSD(const double& frequency) const;
+    void generateBank(const double& samplePeriod_ns, size_t bankSize);
+
+    Spectrum fPSD; //!< (frequency [Hz], PSD [mV^2/Hz]), sorted by frequency.
+    std::vector<double> fBank; //!< One period of synthesised noise [mV].
+    double fRMS; //!< Expected RMS from integrating the PSD [mV].
+    size_t fSequencePos; //!< Next bank position of the current sequence.
+};
+
+#endif /* ColouredNoise_hpp */
@@ -2,6 +2,7 @@
 #define Config_hpp
 
 #include <memory>
+#include <string>
 
 #include "DBInterface.hpp"
 
@@ -12,5 +13,12 @@ typedef std::shared_ptr<DBInterface<std::string>> ConfigPtr;
 extern ConfigPtr config;
 
 ConfigPtr create_default_config();
+
+/**
+ * Return the setting SID from the global config, or fallback if the
+ * loaded DERCONFIG does not define it. Used for optional settings so that
+ * older DERCONFIG files keep working.
+ */
+std::string get_optional_config(const std::string& SID, const std::string& fallback);
 }
 #endif
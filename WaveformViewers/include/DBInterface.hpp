@@ -44,6 +44,7 @@ public:
     virtual TYPE getConfig(const std::string& SID) = 0;
     virtual TYPE getConfig(const std::string& SID, const unsigned int Entry) = 0;
     virtual void setConfig(const std::string& SID, const unsigned int Entry, TYPE val) = 0;
+    virtual bool hasConfig(const std::string& SID);
 
     bool isOK();
 
@@ -81,6 +82,16 @@ bool DBInterface<TYPE>::isOK()
     return confIsOK;
 }
 
+template <class TYPE>
+bool DBInterface<TYPE>::hasConfig(const std::string& SID)
+{
+    /**
+     * Check if the source provides the setting SID. Sources that
+     * cannot answer this report every setting as absent.
+     */
+    return false;
+}
+
 template <class TYPE>
 void DBInterface<TYPE>::Notification(std::string& par1, std::string& par2, std::string& par3)
 {
@@ -32,6 +32,7 @@ public:
     TYPE getConfig(const std::string& SID);
     TYPE getConfig(const std::string& SID, const unsigned int Entry);
     void setConfig(const std::string& SID, const unsigned int Entry, TYPE val);
+    bool hasConfig(const std::string& SID);
 
     void Notification(std::string& par1, std::string& par2, std::string& par3);
 
@@ -93,6 +94,21 @@ template <class TYPE> TYPE DBInterfaceConfig<TYPE>::getConfig(const std::string&
     return 0;
 }
 
+template <class TYPE> bool DBInterfaceConfig<TYPE>::hasConfig(const std::string& SID)
+{
+    /**
+     * Check if a setting with this SID was loaded.
+     */
+
+    for (int i = 0; i < Settings.size(); i++)
+    {
+        if (Settings.at(i).SID == SID)
+            return true;
+    }
+
+    return false;
+}
+
 template <class TYPE> TYPE DBInterfaceConfig<TYPE>::getConfig(const std::string& SID, const unsigned int Entry)
 {
     return TYPE();
@@ -17,6 +17,8 @@
 
 #include "DBInterface.hpp"
 #include "Pulse.hpp"
+#include "SegmentedPulse.hpp"
+#include "SlicedPulse.hpp"
 #include "MCTruth.hpp"
 
 /**
@@ -39,21 +41,53 @@ namespace der{
 class Device
 {
 public:
+    /**
+     * Progress of a device through a SlicedPulse, so that the response can
+     * be resumed when the next slice arrives.
+     */
+    struct SliceState
+    {
+        enum Phase
+        {
+            kFilter, //!< Filtering up to the end of the current interval
+            kBaselineStart, //!< Starting the baseline search
+            kBaseline, //!< Filtering until the baseline has settled
+            kNextInterval, //!< Moving on to the next interval to filter
+            kDone
+        };
+
+        Phase phase;
+        unsigned int interval; //!< Current photon interval
+        unsigned int sample; //!< Next sample to filter
+        double average; //!< Running average of the baseline search
+    };
+
     Device();
     virtual ~Device() = 0;
     std::string getName();
     void setName(std::string name);
     virtual void doResponse(Pulse& thePulse);
     virtual void doResponse(Pulse& theLGPulse, Pulse& theHGPulse);
+    virtual void doResponse(SegmentedPulse& thePulse);
+    virtual void doResponse(SegmentedPulse& theLGPulse, SegmentedPulse& theHGPulse);
+    void startResponse(SlicedPulse& thePulse, SliceState& state);
+    void doResponse(SlicedPulse& thePulse, SliceState& state, const unsigned long& sampleLimit,
+        const unsigned int& intervalLimit);
+    unsigned long getSampleFrontier(const SlicedPulse& thePulse, const SliceState& state) const;
+    unsigned int getIntervalFrontier(const SlicedPulse& thePulse, const SliceState& state) const;
     virtual void doStageResponse(Pulse& thePulse);
     virtual void doStageResponse(Pulse& theLGPulse, Pulse& theHGPulse);
+    virtual void doStageResponse(SegmentedPulse& thePulse);
     virtual void prepareMCTruth(std::shared_ptr<MCTruth> theMCTruth);
     virtual void printRunningTime();
     virtual void runFilters(double& sampleValue);
     virtual void reset();
     virtual void findBaseline(Pulse& thePulse, unsigned int& j);
+    virtual void findBaseline(SegmentedPulse& thePulse, const size_t& segmentNo);
 
 protected:
+    bool canFindNextFilterSample(SlicedPulse& thePulse, const SliceState& state, const unsigned int& intervalLimit);
+
     std::string sName; //!< Name of device
     der::DeviceModel sModel; //!< Model of device
     double fTimeBase;
@@ -12,11 +12,14 @@
 #include <stdio.h>
 #include <math.h>
 #include <complex>
+#include <map>
 
 #include "Device.hpp"
 #include "Filters.hpp"
 #include "Pulse.hpp"
 #include "Config.hpp"
+#include "ColouredNoise.hpp"
+#include "GaussianNoise.hpp"
 
 #include "TRandom.h"
 
@@ -31,15 +34,31 @@ public:
     Digitizer(const der::DeviceModel& model);
     virtual ~Digitizer();
     void doResponse(Pulse& thePulse);
+    void doResponse(SegmentedPulse& thePulse);
     void doStageResponse(Pulse& thePulse);
+    void doStageResponse(SegmentedPulse& thePulse);
+    size_t startSlicedResponse(SlicedPulse& thePulse);
+    void digitizeSlice(SlicedPulse& thePulse, const unsigned long& sampleLimit, std::vector<double>& digitized);
+    void decimateResponse(Pulse& thePulse, std::vector<double>& mV);
+    void digitizeSamples(const unsigned int& channel, const double* mV, const size_t& n, std::vector<double>& digitized);
     void setSamplingInterval(int samplingInterval);
     int digitizePoint(double mV, bool addNoise);
     int mVtoADC(const double& mV);
+    double getBaseline();
+    double getBaselineSigma(const unsigned int& channel) const;
+    bool hasBaselineNoise() const;
     double addBaselineNoise(const double& mV);
     void runFilters(double& sampleValue);
     void reset();
 
 private:
+    void setupColouredNoise(const std::string& psdFile);
+    void fillNoise(const unsigned int& channel, const size_t& n);
+    void startNoiseSequence(const unsigned int& channel, const size_t& n);
+    void fillNextNoise(const unsigned int& channel, const size_t& n);
+    double getNoiseRMS(const unsigned int& channel) const;
+    void downConvert(SegmentedPulse& thePulse, const bool& addNoise);
+
     double fDigMax;
     double fDigMin;
     double fNumBits;
@@ -50,7 +69,14 @@ private:
     int iSamplingInterval;
     bool doNoiseAddition;
     double baselineSigma;
-    bool doDownConvertPhotonIntervals;
+    GaussianNoise fNoiseGenerator; //!< Baseline noise [mV], filled per pulse.
+    std::vector<double> fNoise; //!< Reused noise buffer for doResponse().
+    bool doColouredNoise;
+    std::vector<ColouredNoise> fColouredNoise; //!< One bank per measured PSD.
+    std::map<unsigned int, size_t> fChannelSpectrum; //!< Channel -> fColouredNoise index.
+    size_t fDefaultSpectrum; //!< Bank for channels without their own PSD.
+    size_t fSliceDigitizedSize; //!< Digitised length of the current sliced pulse.
+    size_t fSliceDigitized; //!< Samples of it digitised so far.
     std::array<double, 4> skAccus;
     double skExp;
     double skOneMinusExp;
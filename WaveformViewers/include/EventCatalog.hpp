@@ -0,0 +1,65 @@
+//
+//  EventCatalog.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef EventCatalog_hpp
+#define EventCatalog_hpp
+
+#include <string>
+#include <vector>
+
+/**
+ * Catalog of the events of the input, built once when the input is prepared.
+ *
+ * For every event it holds whether it is available and empty, and its
+ * photon count, PMT count and time span, indexed by event number, so that
+ * lookups are constant time. Once the selection is made, prefix sums over
+ * the selected events answer counts over event ranges in constant time.
+ * Cuts on the catalogued quantities select events without reading photons.
+ */
+
+class EventCatalog
+{
+public:
+    struct Event
+    {
+        unsigned long long nPhotons;
+        unsigned int nPMTs;
+        double timeSpan; //[ns] last - first photon time
+    };
+
+    EventCatalog();
+    ~EventCatalog();
+
+    void clear();
+    void addEvent(const unsigned long long& evt, const Event& theEvent, const bool& isEmpty);
+    void select(const std::vector<unsigned long long>& theEvents);
+    std::vector<unsigned long long> applyCut(const std::string& cut,
+        const std::vector<unsigned long long>& theEvents) const;
+
+    bool isAvailable(const unsigned long long& evt) const;
+    bool isEmpty(const unsigned long long& evt) const;
+    bool isSelected(const unsigned long long& evt) const;
+    const Event& at(const unsigned long long& evt) const;
+
+    unsigned long long getNSelected() const;
+    unsigned long long getNSelectedNonEmpty() const;
+    unsigned long long countSelected(const unsigned long long& first, const unsigned long long& last) const;
+    unsigned long long countSelectedNonEmpty(const unsigned long long& first, const unsigned long long& last) const;
+    unsigned long long countSelectedPhotons(const unsigned long long& first, const unsigned long long& last) const;
+
+private:
+    unsigned long long prefix(const std::vector<unsigned long long>& theSums, const unsigned long long& evt) const;
+
+    std::vector<Event> fEvents; //!< By event number.
+    std::vector<bool> fAvailable;
+    std::vector<bool> fEmpty;
+    std::vector<bool> fSelected;
+    std::vector<unsigned long long> fSelectedBefore; //!< Selected events before each event.
+    std::vector<unsigned long long> fNonEmptyBefore; //!< Selected non-empty events before each event.
+    std::vector<unsigned long long> fPhotonsBefore; //!< Photons of the selected events before each event.
+};
+#endif /* EventCatalog_hpp */
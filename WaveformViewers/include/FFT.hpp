@@ -34,6 +34,7 @@ public:
     ~FFT();
 
     void doRealFFT(Pulse& thePulse);
+    void doComplexFFT(std::vector<double>& data, Bool_t forward);
     void PlotFFT(const std::string& name,
         const std::string& evt,
         const std::string& channel,
@@ -42,6 +43,7 @@ public:
 private:
     void RealFFT(std::vector<double>& data, Bool_t forward);
     void ToPwr2(std::vector<double>& data);
+    void PadToPwr2(std::vector<double>& data);
     void BitReversal(std::vector<double>& data);
     void DLLemma(std::vector<double>& data, const Bool_t invert);
     void Fourier(std::vector<double>& data, Bool_t forward);
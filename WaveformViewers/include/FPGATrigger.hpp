@@ -9,25 +9,66 @@
 #ifndef FPGATrigger_hpp
 #define FPGATrigger_hpp
 
+#include <functional>
 #include <stdio.h>
+#include <string>
+#include <vector>
 
 #include "POD.hpp"
 
 //Trigger from:
 //https://arxiv.org/pdf/1511.03541.pdf
+//
+//The trapezoidal filter is evaluated as the FPGA does, in integers from
+//running sums of the ADC samples. calculateFilterResponse() is the floating
+//point reference it reproduces; setting TriggerFilterCheck compares the two
+//on every POD. A stream of samples is filtered with startFilterStream() and
+//filterSamples(), one chunk at a time.
+//
+//The trigger points of each channel are kept apart, in time order, and
+//merged with a heap, which takes O(N log k) for N points on k channels
+//rather than a sort of all of them. buildEventTriggers() evaluates all
+//trigger types over sliding windows as the points leave the heap.
 
 class FPGATrigger
 {
 public:
+    enum TriggerKind
+    {
+        kMultiplicity, //Number of channels with a trigger point in the window
+        kSum //Sum of the filter responses of the trigger points in the window
+    };
+
+    struct TriggerType
+    {
+        std::string name;
+        TriggerKind kind;
+        unsigned int window; //Trigger points less than window before the latest count
+        double requirement; //Multiplicity or sum needed to trigger
+    };
+
+    struct EventTrigger
+    {
+        unsigned long long time; //Time of the trigger point completing the requirement
+        size_t type; //Index of the TriggerType
+        double value; //Multiplicity or sum at that point
+    };
+
     FPGATrigger(const std::string& model);
     ~FPGATrigger();
     double calculateFilterResponse(std::shared_ptr<POD> thePOD, const size_t index);
+    void startFilterStream();
+    void filterSamples(const short* samples, const size_t nSamples, short* response);
+    void checkFilterStream();
     std::shared_ptr<POD> processPOD(std::shared_ptr<POD> thePOD);
     void resetPODParameters();
     void addTriggeredChannel(unsigned int channel);
     size_t getTriggeredChannelsSize();
     std::vector<unsigned long long>& getTriggerPoints();
     bool isPossibleForTrigger();
+    size_t addTriggerType(const TriggerType& type);
+    const std::vector<TriggerType>& getTriggerTypes() const;
+    const std::vector<EventTrigger>& buildEventTriggers();
 
 private:
   double A;
@@ -43,9 +84,37 @@ private:
   size_t previousFilteredIndex;
   double filterResponse;
 
-  std::vector<unsigned long long> triggeredTimeStamps;
+  long long weightA; //A in units of 1/kFilterScale
+  long long weightB; //B in units of 1/kFilterScale
+  unsigned int filterN;
+  unsigned int filterM;
+  bool streamStarted;
+  long long streamFirstSample; //First sample of the stream, less DC offset
+  std::vector<long long> streamSums; //Running sums of the last 2n+m samples, then of the chunk
+  short sampleThreshold; //threshold, as compared with the short responses
+  bool checkFilter; //Compare filterSamples() with calculateFilterResponse()
+
+  struct TriggerPoint
+  {
+    unsigned long long time;
+    unsigned int channel;
+    int response; //Filter response, less the DC offset
+  };
+
+  struct ChannelTriggerPoints
+  {
+    unsigned int channel;
+    std::vector<TriggerPoint> points; //In time order
+  };
+
+  void mergeTriggerPoints(const std::function<void(const TriggerPoint&)>& visit);
+
+  std::vector<ChannelTriggerPoints> channelTriggerPoints;
+  size_t nTriggerPoints;
   std::vector<unsigned int> triggeredChannels;
   std::vector<unsigned long long> eventTriggerPoints;
+  std::vector<TriggerType> triggerTypes;
+  std::vector<EventTrigger> eventTriggers;
   
 };
 
@@ -0,0 +1,136 @@
+//
+//  FlatPhotonInput.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef FlatPhotonInput_hpp
+#define FlatPhotonInput_hpp
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Input.hpp"
+
+/**
+ * Input of the flat photon format, memory-mapped read-only.
+ *
+ * A flat photon file holds what the DER reads from a BACCARAT file: an event
+ * directory with the photon times of each event, a table of the PMTs hit in
+ * each event with the range of their photons, and one contiguous column per
+ * photon member. The photons of a PMT in an event are one range of the
+ * columns, which are read where they are mapped, so the input costs little
+ * more than the page faults, and the workers on a node that read the same
+ * file share its pages in the page cache. Files are written from
+ * BaccRootConverter files by RootInputMDC2::writeFlatPhotons(). Dark counts
+ * are not stored; they are drawn on every run as for the ROOT input.
+ *
+ * The layout is native-endian. The sections start at the offsets in the
+ * Header, aligned to 8 bytes.
+ */
+
+class FlatPhotonInput : public Input
+{
+public:
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t nChannels; //!< PMT channels of the detector.
+        std::uint64_t nEvents;
+        std::uint64_t nPMTs; //!< PMT table entries, over all events.
+        std::uint64_t nPhotons;
+        std::uint64_t userNameLength;
+        std::uint64_t eventsOffset;
+        std::uint64_t pmtsOffset;
+        std::uint64_t timeOffset; //!< double [ns], as in PhotonMCTruth
+        std::uint64_t wavelengthOffset; //!< double [nm]
+        std::uint64_t interactionIDOffset; //!< int32
+        std::uint64_t vertexNumberOffset; //!< int32
+        std::uint64_t pulseIDOffset; //!< int32
+        std::uint64_t userNameOffset; //!< char
+    };
+
+    struct EventEntry
+    {
+        double firstPhotonTime; //[ns]
+        double lastPhotonTime; //[ns]
+        double parentTime; //[ns]
+        double referencePhotonTime; //[ns]
+        std::int32_t runNumber;
+        std::int32_t nVertices;
+        std::uint64_t firstPMT; //!< First entry of the event in the PMT table.
+        std::uint32_t nPMTs;
+        std::uint32_t reserved;
+    };
+
+    struct PMTEntry
+    {
+        std::int32_t pmt;
+        std::uint32_t nPhotons;
+        std::uint64_t firstPhoton; //!< First photon of the PMT in the columns.
+    };
+
+    static const char kMagic[8];
+    static const std::uint32_t kVersion;
+
+    static Header makeHeader(const std::uint32_t& nChannels, const std::uint64_t& nEvents,
+        const std::uint64_t& nPMTs, const std::uint64_t& nPhotons, const std::uint64_t& userNameLength);
+
+    FlatPhotonInput();
+    ~FlatPhotonInput();
+    TFile* getFilePointer();
+    bool Open();
+    void Close();
+    int makePMTDataReady();
+    int makePMTDataReady(const unsigned long long& Evt,
+        unsigned long long& NPhotons,
+        unsigned long long& TMin,
+        unsigned long long& TMax,
+        unsigned long long& NVertices,
+        std::vector<int>& PmtsInEvt);
+    bool getPMTData(const unsigned long long evt);
+    bool getPMTData(const unsigned long long evt,
+        int pmt,
+        std::shared_ptr<PMT> thePMT,
+        unsigned long eventLength,
+        unsigned long long timeShift,
+        unsigned long long TimeShiftInce,
+        unsigned long long k);
+    std::string getUserName();
+    double getEventFirstPhotonTime(unsigned long long evt);
+    const EventEntry& getEventEntry(const unsigned long long& evt) const;
+
+protected:
+    /**
+     * A PMT of an event, with its entry in the PMT table, or none if it only
+     * has dark counts.
+     */
+    struct PMTInfo
+    {
+        int PMTnumber;
+        const PMTEntry* photons;
+        int NumberOfDarkCounts;
+    };
+
+    std::vector<std::vector<PMTInfo>> fEventPMTs; //!< PMTs of each event.
+    std::vector<unsigned long long> fEventNPhotons; //!< Photons of each event.
+
+    unsigned long long fPreEventWindow;
+    unsigned long long fPostEventWindow;
+
+    const char* fMapped; //!< The mapped file.
+    size_t fMappedSize; //[bytes]
+    const Header* fHeader;
+    const EventEntry* fEvents;
+    const PMTEntry* fPMTs;
+    const double* fTime;
+    const double* fWavelength;
+    const std::int32_t* fInteractionID;
+    const std::int32_t* fVertexNumber;
+    const std::int32_t* fPulseID;
+};
+
+#endif /* FlatPhotonInput_hpp */
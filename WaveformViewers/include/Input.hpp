@@ -11,6 +11,9 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
+#include <memory>
+#include <random>
 #include <set>
 #include <stdio.h>
 #include <string>
@@ -20,7 +23,9 @@
 
 #include "DBInterface.hpp"
 #include "Config.hpp"
+#include "EventCatalog.hpp"
 #include "InputOutputFormats.hpp"
+#include "PhotonPrefetcher.hpp"
 #include "Pulse.hpp"
 #include "PMT.hpp"
 
@@ -61,6 +66,10 @@ protected:
 
     std::vector<unsigned long long> AvailableEvents;
     std::vector<unsigned long long> SelectedEvents; //Select events
+    EventCatalog fCatalog; //!< Available and selected events, by event number.
+
+    void addAvailableEvent(const unsigned long long& evt, const unsigned long long& nPhotons,
+        const unsigned int& nPMTs, const double& timeSpan, const bool& isEmpty);
 
     std::vector<double> AllEventFirstPhotonTimes_ns;
 
@@ -68,8 +77,6 @@ protected:
 
     bool ComparePMTData(PMTData const& lhs,
         PMTData const& rhs);
-    bool EventIsContained(const int ID,
-        const std::vector<unsigned long long>& FindIn);
     std::string getSeedFromFile(const std::string& inFilename);
     bool PMTwasFound(const std::vector<int>& vec,
         const int& val);
@@ -77,6 +84,8 @@ protected:
 
     bool checkForMissingPMTs();
 
+    int determineDarkCounts(const unsigned long length, double darkCountRate);
+
     void SortData();
 
     //Detector selection
@@ -119,6 +128,14 @@ protected:
     TChain* data; //Pointer to input chain of data files.
     //Only Jul2017 and later currently support using this variable.
 
+    virtual bool readsEventPhotons() const;
+    virtual void readEventPhotons(const unsigned long long& evt, PhotonPrefetcher::EventPhotons& thePhotons);
+    const PhotonPrefetcher::EventPhotons& getEventPhotons(const unsigned long long& evt);
+
+    std::unique_ptr<PhotonPrefetcher> fPrefetcher; //!< Set while the photons are prefetched.
+    PhotonPrefetcher::EventPhotons fEventPhotons; //!< Photons read without prefetching.
+    unsigned long long fEventPhotonsEvt; //!< Event of fEventPhotons.
+
 public:
     Input();
     virtual ~Input() = 0;
@@ -170,6 +187,9 @@ public:
     std::string getRandomSeedFromFileName();
     TChain* getDataTChain();
 
+    void startPrefetch(const unsigned int& depth);
+    void stopPrefetch();
+
     PMTData* PMTDataAt(const unsigned long long it);
     virtual void getBaccObj();
     virtual double getEventFirstPhotonTime(unsigned long long evt);
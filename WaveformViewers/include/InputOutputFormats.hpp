@@ -19,7 +19,8 @@ enum class revision : unsigned short
     Off = 0,
     BINv1 = 1,
     ROOTvMDC1 = 2,
-    ROOTvMDC2 = 3
+    ROOTvMDC2 = 3,
+    FLATv1 = 4
 };
 
 //Formats pertaining to configuration and database parameters
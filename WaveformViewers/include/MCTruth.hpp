@@ -9,6 +9,8 @@
 #ifndef MCTruth_hpp
 #define MCTruth_hpp
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <stdio.h>
 #include <vector>
@@ -23,17 +25,23 @@
  * The typical use of this class is: at the PMT stage a MCTruthData object is created
  * for every incoming photon hitting a PMT. All MCTruthData objects for one PMT are 
  * stored in a vector. After the PODs for the corresponding high and low gain channels 
- * are created, a PODTruth instance is added containing pointers to all MCTruthData objects
+ * are created, a PODTruth instance is added referring to all MCTruthData objects
  * belonging to this POD. All PODTruth objects for a channel are stored in a vector,  
  * which is then passed to the ouput stage.
  * 
- * Currently the phdArrivaltime is stored in the MCTruthData, they could be replaced by 
- * referring to indices.
+ * The photons are stored in columns of narrow types and a PODTruth refers to
+ * its photons by a range of the photons sorted by arrival time, so no
+ * per-photon structure is copied until the truth is written.
  */
 
 class MCTruth
 {
-protected:
+public:
+    /**
+     * Truth of a single photon. The photons are stored column by column, see
+     * TruthColumns, and this structure is only built when it is requested
+     * with getMCTruthData(), i.e. when the truth is written.
+     */
     struct MCTruthData
     {
         unsigned long long ArrivalTime; //[ns] Arrival time
@@ -53,18 +61,60 @@ protected:
         //added to sum of photons in pods yet.
     };
 
+protected:
+    /**
+     * Truth of all photons of the channel, one column per quantity with the
+     * narrowest type that holds it. The DER event and run number are the
+     * same for every photon in a POD and are kept once (podEvent and
+     * podRunNumber) for the photons flagged kInPOD.
+     */
+    struct TruthColumns
+    {
+        std::vector<uint32_t> ArrivalTime; //[ns] within the event window
+        std::vector<float> wavelength; //[nm]
+        std::vector<uint16_t> PMTNumber;
+        std::vector<uint32_t> SimEvt;
+        std::vector<uint8_t> pheType;
+        std::vector<uint8_t> InteractionIdentifier;
+        std::vector<int16_t> VertexNumber;
+        std::vector<uint16_t> PulseID;
+        std::vector<uint16_t> HGPODIdx;
+        std::vector<uint16_t> LGPODIdx;
+        std::vector<uint8_t> flags; //kIsDER and kInPOD
+    };
+
+    enum TruthFlags : uint8_t
+    {
+        kIsDER = 1,
+        kInPOD = 2 //Photon is in a POD, the 'counted' of MCTruthData
+    };
+
+    /**
+     * Photons of a POD, as a range of timeOrder.
+     */
     struct PODTruth
     {
-        std::vector<MCTruthData*> PtrToMCTruth; //Pointers to MCTruthData
+        unsigned long first; //First photon in timeOrder
+        unsigned long last; //One past the last photon in timeOrder
         unsigned long channel; //DER Channel
         unsigned long long Event; //DER Event
     };
 
-    std::vector<MCTruthData> theMCTruthData;
+    TruthColumns theTruthColumns;
+    unsigned long truthSize;
+    unsigned long podEvent; //DER event of the photons in PODs
+    int podRunNumber; //Simulation run number of the photons in PODs
     std::vector<PODTruth> thePODTruth;
     int nPhotonsInPODs;
     int nDarkCounts;
 
+    std::vector<unsigned long> timeOrder; //Photon entries sorted by time
+    std::vector<uint32_t> timeOrderTimes; //Their arrival times
+    bool timeOrderValid; //False if timeOrder must be rebuilt
+
+    void buildTimeOrder();
+    void addPODIdx(const unsigned long idx, const unsigned long DEREvt, const int SimRunNum);
+
 public:
     MCTruth();
     ~MCTruth();
@@ -92,7 +142,14 @@ public:
         const unsigned long DEREvt,
         const int SimRunNum);
 
-    MCTruthData* getMCTruthDataObject(const int idx);
+    MCTruthData getMCTruthData(const unsigned long idx) const;
+    bool isInPOD(const unsigned long idx) const;
+
+    void findTruthInWindow(const unsigned long long startTime,
+        const unsigned long long endTime,
+        unsigned long& first,
+        unsigned long& last);
+    unsigned long getTimeOrderedIdx(const unsigned long i) const;
 
     void setPODTruthSize(const unsigned long size);
     unsigned long getPODTruthSize();
@@ -107,7 +164,8 @@ public:
     void setPODTruthAt(const unsigned long idx,
         const unsigned long channel,
         const unsigned long Event,
-        MCTruthData* Ptr);
+        const unsigned long first,
+        const unsigned long last);
 
     PODTruth* getPODTruthObject(const int idx);
 };
@@ -27,6 +27,7 @@
 #include "EBGlobal.hpp"
 #include "EBSummary.hpp"
 #include "MCTruth.hpp"
+#include "PODArena.hpp"
 #include "PODContainer.hpp"
 #include "PulseManager.hpp"
 #include "RootInput.hpp"
@@ -56,6 +57,7 @@ public:
     virtual void doWriteGlobal(EBGlobal* theGlobalSummary = NULL) = 0;
     virtual void doWriteEvent(EBEvent& theEBEvent) = 0;
     virtual void doWriteData(POD& theEBDataPOD, const int& DCID) = 0;
+    virtual void doWriteData(const PODArena& thePODs);
     virtual void doWriteSummary(EBSummary& theEBSummary) = 0;
     virtual void doPrepareEvent() = 0;
     virtual void doWriteTruthTree() = 0;
@@ -74,6 +74,10 @@ public:
     void setPMTNumber(unsigned int realLZPMTNumber);
     void doResponse(Pulse& thePulse);
     void doResponse(Pulse& theLGPulse, Pulse& theHGPulse);
+    void doResponse(SegmentedPulse& thePulse);
+    void doResponse(SlicedPulse& thePulse);
+    void repeatResponse(SlicedPulse& thePulse);
+    void fillSlice(SlicedPulse& thePulse, const unsigned long& first, const unsigned long& last);
     void prepareMCTruth(std::shared_ptr<MCTruth> theTruth);
     void resetPMTVectors();
     void printRunningTime();
@@ -144,6 +148,12 @@ private:
     //PMT pulse parameters
     std::vector<double> fPmtPulseSamples;
 
+    //Hits of the last sliced response, see drawHits()
+    std::vector<std::pair<unsigned long long, double> > fSlicedHits;
+    unsigned long fSlicedNhalf;
+    unsigned long fSlicedStartPoint;
+    unsigned long fSlicedEndPoint;
+
     //Scale gains for analytic PMT response
     double fAnalyticGainFactor;
     double fNominalScaleGain;
@@ -181,6 +191,9 @@ private:
     photonResp biasedDieWithAP(const double wavelength);
     double getGaussSpread(const double, const double);
     void doAnalyticPMTResponse(Pulse& thePulse);
+    void doAnalyticPMTResponse(SegmentedPulse& thePulse);
+    void drawHits(std::vector<std::pair<unsigned long long, double> >& hits, unsigned long& Nhalf,
+        unsigned long& startPoint, unsigned long& endPoint);
     void doSampledPMTResponse(Pulse& thePulse,
         Pulse& thePulseHG);
     void constructBasePMTPulse(const unsigned long N);
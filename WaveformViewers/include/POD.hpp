@@ -51,6 +51,9 @@ public:
     void setElementSamplingRate(const int& rate);
 
     void setMCTruth(std::shared_ptr<MCTruth> theTruth);
+    static unsigned long long addMCTruth(std::shared_ptr<MCTruth> theTruth, const int& channel,
+        const unsigned long long& event, const int& luxSimRunNumber, const unsigned long long& startTime,
+        const size_t& nSamples, const int& samplingRate, unsigned long& first, unsigned long& last);
 
     void setIsTriggered(const bool value);
     bool getIsTriggered() const;
@@ -60,7 +63,10 @@ public:
     unsigned long long getTriggeredTimeStamp() const;
 
 private:
-    void set_mctruth(std::shared_ptr<MCTruth> theTruth, const unsigned long long& idx, bool highGain) const;
+    static void set_mctruth(std::shared_ptr<MCTruth> theTruth, const unsigned long long& idx, bool highGain,
+        const int& channel, const unsigned long long& event, const int& luxSimRunNumber,
+        const unsigned long long& podStartTime, const size_t& nSamples, const int& samplingRate,
+        unsigned long& first, unsigned long& last);
 
 private:
     unsigned long long fEvent; //!< Event the POD is on.
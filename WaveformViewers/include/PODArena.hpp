@@ -0,0 +1,68 @@
+//
+//  PODArena.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef PODArena_hpp
+#define PODArena_hpp
+
+#include <memory>
+#include <vector>
+
+#include "MCTruth.hpp"
+
+/**
+ * Flat storage for the PODs of an event.
+ *
+ * The samples of all PODs are kept back to back in one buffer and each POD
+ * is described by a Descriptor holding its metadata and the offset of its
+ * samples. The arena is cleared, not freed, between events, so forming and
+ * writing PODs makes no heap allocations once the buffers have grown to the
+ * size of a typical event. Writers iterate over the descriptors in order and
+ * can write the samples of a POD as one block.
+ */
+
+class PODArena
+{
+public:
+    struct Descriptor
+    {
+        unsigned long long event; //!< Event the POD is on.
+        int luxSimRunNumber; //!< LUXSim Run number
+        int channel; //!< Channel the POD is on.
+        int dataCollector; //!< DC on which the POD belongs.
+        short hitID; //!< Number of POD in sequence.
+        unsigned long long start; //!< Start time of POD.
+        unsigned long long length; //!< Length of POD in samples.
+        size_t offset; //!< Index of the first sample in the arena.
+        bool highGain; //!< Whether the POD is on a high gain channel.
+        unsigned long truthFirst; //!< First time ordered MCTruth photon in the POD.
+        unsigned long truthLast; //!< One past the last, equal to truthFirst if none.
+    };
+
+    PODArena();
+    ~PODArena();
+
+    void clear();
+
+    Descriptor& addPOD(const unsigned long long& length);
+
+    size_t size() const;
+    Descriptor& at(const size_t& i);
+    const Descriptor& at(const size_t& i) const;
+
+    short* getSamples(const Descriptor& thePOD);
+    const short* getSamples(const Descriptor& thePOD) const;
+
+    int getSamplingRate() const;
+
+    void setMCTruth(const size_t& first, std::shared_ptr<MCTruth> theTruth);
+
+private:
+    std::vector<short> fSamples; //!< Samples of all PODs.
+    std::vector<Descriptor> fPODs; //!< PODs in the order they were added.
+    int fSamplingRate; //[ns]
+};
+#endif /* PODArena_hpp */
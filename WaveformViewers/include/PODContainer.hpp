@@ -18,7 +18,9 @@
 #include "MCTruth.hpp"
 #include "PMTLookup.hpp"
 #include "POD.hpp"
+#include "PODArena.hpp"
 #include "Pulse.hpp"
+#include "SegmentedPulse.hpp"
 
 /**
  * Class providing the necessary interface and tools to form PODs from
@@ -34,6 +36,18 @@
  * where the user of the class provides a loop which checks the conditional
  * hasMorePODS() to extract them all.
  *
+ * A pulse that is processed in time slices is supplied piece by piece with
+ * startPODContainer(), addPODContainerSamples() and finishPODContainer(),
+ * which give the same PODs.
+ *
+ * If an arena is set with setArena(), the PODs are added to it instead of
+ * being stored as POD objects in this container.
+ *
+ * With the PODBaseline setting "fixed", the trigger compares the samples with
+ * the baseline and noise of the digitiser, which simulated pulses carry,
+ * instead of a rolling estimate. Only the photon intervals or segments of
+ * such a pulse are then scanned, as everything else is baseline.
+ *
  * In future this class will change internally for improved performance.
  * It is not anticipated that the usage of the class will change external to
  * this class.
@@ -49,6 +63,15 @@ public:
     void fillPODContainerFromPulse(Pulse& thePulse, 
 				   std::shared_ptr<MCTruth> theMCTruth,
 				   const std::string& LGHG);
+    void fillPODContainerFromPulse(const SegmentedPulse& thePulse,
+				   std::shared_ptr<MCTruth> theMCTruth,
+				   const std::string& LGHG);
+
+    void startPODContainer(const unsigned int& pmtChannel, const unsigned long long& event,
+			   const int& luxSimRunNumber, const unsigned long& length,
+			   std::shared_ptr<MCTruth> theMCTruth, const std::string& LGHG);
+    void addPODContainerSamples(const std::vector<double>& samples);
+    void finishPODContainer();
 
     std::shared_ptr<POD> getNextPOD();
 
@@ -56,8 +79,11 @@ public:
 
     std::shared_ptr<PODContainer> makePODsFromBoundaries(std::shared_ptr<Pulse> thePulse);
     std::shared_ptr<PODContainer> makePODsFromBoundaries(Pulse& thePulse);
+    std::shared_ptr<PODContainer> makePODsFromBoundaries(std::shared_ptr<SegmentedPulse> thePulse);
 
     void setElementSamplingRate(const int& rate);
+    void setArena(PODArena* arena);
+    void setBaseline(const double& baseline, const double& sigma);
 
     void resetPODCounter();
 
@@ -65,6 +91,62 @@ public:
     const std::vector<unsigned long long>& getPodEnds() const;
 
 private:
+    /**
+     * State of the trigger scan over a pulse, which is carried between calls
+     * of addPODContainerSamples().
+     */
+    struct ScanState
+    {
+        bool active; //!< False if the pulse is too short for PODs
+        unsigned int channel;
+        unsigned short dcNumber;
+        unsigned long event;
+        int luxSimRunNumber;
+        bool highGain;
+        std::shared_ptr<MCTruth> mcTruth;
+
+        unsigned int timeThreshold;
+        bool fixedBaseline; //!< bsl and lrms are the digitiser values
+        bool isAboveThresh;
+        unsigned long long threshtimer;
+        unsigned long long potentialStart;
+        bool isProtoPod;
+
+        double sum;
+        double mean;
+        double bsl;
+        double lrms;
+        double ex;
+        double RMSs;
+        double bslHOLD;
+        bool holdbsl;
+        unsigned long long ctr;
+        unsigned long minWindow;
+        unsigned long maxWindow;
+
+        bool hasGroup; //!< Whether a POD is being merged from waveforms
+        unsigned long long groupStart; //!< Start of its first waveform
+        unsigned long long groupEnd; //!< End of its last waveform
+    };
+
+    template <class PulseType>
+    void fillPODContainer(const PulseType& thePulse, std::shared_ptr<MCTruth> theMCTruth, const std::string& LGHG);
+    void beginScan(const unsigned int& pmtChannel, const unsigned long long& event, const int& luxSimRunNumber,
+		   const unsigned long& length, std::shared_ptr<MCTruth> theMCTruth, const std::string& LGHG);
+    void startBaseline(const double& firstSample);
+    void scanSample(const unsigned long& i, const double& theVal, const double& var);
+    void scanSamples(const double* samples, const unsigned long& first, const unsigned long& n);
+    void scanFixed(const double* samples, const unsigned long& first, const unsigned long& n);
+    void skipBaseline(const unsigned long& first, const unsigned long& last);
+    void addProtoPod(const unsigned long long& start, const unsigned long long& length);
+    void endScan();
+    template <class PulseType>
+    void extractPOD(const size_t& podNo, const PulseType& thePulse);
+    template <class PulseType>
+    std::shared_ptr<POD> makePOD(const size_t& podNo, const PulseType& thePulse);
+    template <class PulseType>
+    void addArenaPOD(const size_t& podNo, const PulseType& thePulse);
+
     std::vector<unsigned long long> podStarts;
     std::vector<unsigned long long> podEnds;
 
@@ -82,5 +164,15 @@ private:
     unsigned long postTriggerSamples;
 
     double podTriggerThreshold; //!< [ADCC] Trigger threshold
+
+    ScanState fScan;
+    PODArena* fArena; //!< Arena the PODs are added to, if any
+    bool fHasBaseline; //!< Whether the digitiser baseline is known
+    double fBaseline; //!< [ADCC] Digitiser baseline
+    double fBaselineSigma; //!< [ADCC] Digitiser noise
+    std::vector<double> fStreamSamples; //!< Kept samples of a streamed pulse
+    unsigned long fStreamFirst; //!< Index of fStreamSamples[0] in the pulse
+    unsigned long fStreamNext; //!< Index of the next sample to be streamed
+    size_t fStreamExtracted; //!< Number of PODs cut from the streamed pulse
 };
 #endif /* PODContainer_hpp */
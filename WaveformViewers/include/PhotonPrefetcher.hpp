@@ -0,0 +1,90 @@
+//
+//  PhotonPrefetcher.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef PhotonPrefetcher_hpp
+#define PhotonPrefetcher_hpp
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Reads the photons of the next selected events in a background thread.
+ *
+ * The photons of an event are read by the Reader of the input into the
+ * columns of one slot, one PhotonColumns per PMT of the event. There are
+ * depth + 1 slots, reused in turn, so the worker reads up to depth events
+ * ahead of the event being simulated and allocates nothing once the slots
+ * have grown. get() returns the slot of an event, waiting for the worker
+ * only if it is not read yet; how often and how long it waits is kept, to
+ * tell whether the input or the simulation is the bottleneck.
+ */
+
+class PhotonPrefetcher
+{
+public:
+    /**
+     * Photons of one PMT in one event, one contiguous array per member.
+     */
+    struct PhotonColumns
+    {
+        int pmt;
+        std::vector<double> time; //[ns]
+        std::vector<double> wavelength; //[nm]
+        std::vector<int> interactionID;
+        std::vector<int> vertexNumber;
+        std::vector<int> pulseID;
+    };
+
+    /**
+     * Photons of the PMTs of an event. The vector is grown but never shrunk,
+     * so only the PMTs of the event are valid and the rest are stale.
+     */
+    typedef std::vector<PhotonColumns> EventPhotons;
+    typedef std::function<void(const unsigned long long& evt, EventPhotons& thePhotons)> Reader;
+
+    PhotonPrefetcher(Reader theReader, const std::vector<unsigned long long>& theEvents, const unsigned int& depth);
+    ~PhotonPrefetcher();
+
+    const EventPhotons& get(const unsigned long long& evt);
+
+    unsigned long long getNEvents() const;
+    unsigned long long getNWaits() const;
+    double getWaitTime() const;
+
+private:
+    struct Slot
+    {
+        unsigned long long evt;
+        EventPhotons photons;
+    };
+
+    void run();
+
+    Reader fReader;
+    std::vector<unsigned long long> fEvents; //!< Events in the order they are simulated.
+    std::vector<Slot> fSlots; //!< Slot i % size holds event i.
+    size_t fRead; //!< Events read by the worker.
+    size_t fReleased; //!< Events whose slots the simulation is done with.
+    size_t fCurrent; //!< Event whose slot get() returned last.
+    bool fStop;
+    std::exception_ptr fError; //!< Exception of the worker, rethrown by get().
+    std::mutex fMutex;
+    std::mutex fReaderMutex; //!< Held while the Reader runs.
+    std::condition_variable fReadCondition; //!< Signalled when an event is read.
+    std::condition_variable fFreeCondition; //!< Signalled when a slot is released.
+    std::thread fWorker;
+
+    Slot fDirect; //!< Events read in the calling thread, if out of order.
+    unsigned long long fNEvents; //!< Events returned by get().
+    unsigned long long fNWaits; //!< Events get() waited for.
+    double fWaitTime; //[s]
+};
+#endif /* PhotonPrefetcher_hpp */
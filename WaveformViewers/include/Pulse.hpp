@@ -11,6 +11,7 @@
 
 #include <cmath>
 #include <iostream>
+#include <map>
 #include <set>
 #include <stdio.h>
 #include <string>
@@ -25,6 +26,11 @@
 #include "TLegend.h"
 #include "TStyle.h"
 
+#include "AlignedAllocator.hpp"
+#include "PulseMath.hpp"
+
+typedef std::vector<double, AlignedAllocator<double, 64> > PulseSamples; //!< Cache-line aligned sample storage
+
 /**
  * Class providing the interface and implementation of pulse.
  *
@@ -35,9 +41,12 @@
  * while retaining the key information (the response). Management for these
  * quantities happens by a user of the class, in order to provide near direct
  * access to the pulse information.
+ *
+ * The samples are 64-byte aligned, and the arithmetic operators use the
+ * PulseMath kernels, which callers can also apply directly to data().
  */
 
-class Pulse : public std::vector<double>
+class Pulse : public PulseSamples
 {
 public:
     Pulse();
@@ -60,6 +69,8 @@ public:
     void setChannel(unsigned int cn);
 
     void setLUXSimEvtNumSize(const unsigned long& size);
+    void setLUXSimEvtRange(const unsigned long& first, const unsigned long& last, const unsigned long long sim);
+    size_t getNLUXSimEvtRanges() const;
 
     unsigned long long getLUXSimEvtNum(const int& form, const unsigned long idx = 0) const;
     void setLUXSimEvtNum(const int& form, const unsigned long long sim, const unsigned long idx = 0);
@@ -76,61 +87,49 @@ public:
     void setIsIntervalOverlapping(const unsigned int i, const bool isOverlapping);
     void findNextFilterSample(unsigned int& intervalNo, unsigned int& sampleNo);
 
-    const std::vector<double>& getSamples() const;
+    const PulseSamples& getSamples() const;
 
-    Pulse operator+(const Pulse& thePulse)
+    void clearPhotonIntervals();
+    void setBaseline(const double& baseline, const double& sigma);
+    void clearBaseline();
+    bool hasBaseline() const;
+    double getBaseline() const;
+    double getBaselineSigma() const;
+    void assignTouched(const Pulse& other);
+    PulseSamples& getOutputBuffer();
+    void swapOutputBuffer();
+    bool isOutputBufferSwapped() const;
+
+    Pulse operator+(const Pulse& thePulse) const
     {
-      if(this->size() == thePulse.size())
-	{
-	  for(auto it = this->begin(); it != this->end(); ++it)
-	    *it += thePulse[it-this->begin()];
-	}
-      else
-        {
-            std::cout << "Warning: pulses not of equal length" << std::endl;
-	    return *this;
-	}
+        Pulse theSum(*this);
+        theSum += thePulse;
+        return theSum;
+    }
+
+    Pulse operator-(const Pulse& thePulse) const
+    {
+        Pulse theDifference(*this);
+        theDifference -= thePulse;
+        return theDifference;
     }
 
-    Pulse operator-(const Pulse& thePulse)
+    Pulse& operator+=(const Pulse& thePulse)
     {
-      if(this->size() == thePulse.size())
-	{
-	  for(auto it = this->begin(); it != this->end(); ++it)
-	    *it -= thePulse[it-this->begin()];
-	}
-      else
-        {
-	  std::cout << "Warning: pulses not of equal length" << std::endl;
-	  return *this;
-	}
+        if (this->size() == thePulse.size())
+            PulseMath::add(this->data(), thePulse.data(), this->size());
+        else
+            std::cout << "Warning: pulses not of equal length" << std::endl;
+        return *this;
     }
 
-  
-    Pulse operator+=(const Pulse& thePulse)
-     {
-       if(this->size() == thePulse.size())
-	 {
-	   for(auto it = this->begin(); it != this->end(); ++it)
-	     *it += thePulse[it-this->begin()];
-	 }
-       else
-	 {
-	   std::cout << "Warning: pulses not of equal length" << std::endl;
-	 }
-     }
-
-    Pulse operator-=(const Pulse& thePulse)
+    Pulse& operator-=(const Pulse& thePulse)
     {
-      if(this->size() == thePulse.size())
-	{
-	  for(auto it = this->begin(); it != this->end(); ++it)
-	    *it -= thePulse[it-this->begin()];
-	}
-      else
-        {
-	  std::cout << "Warning: pulses not of equal length" << std::endl;
-	}
+        if (this->size() == thePulse.size())
+            PulseMath::subtract(this->data(), thePulse.data(), this->size());
+        else
+            std::cout << "Warning: pulses not of equal length" << std::endl;
+        return *this;
     }
 
 protected:
@@ -142,11 +141,19 @@ protected:
     unsigned long fLastItPos;
 
     int fLuxSimRunNumber;
-    std::vector<unsigned long long> fLuxSimEvtNumbers;
+    std::map<unsigned long, unsigned long long> fLuxSimEvtNumbers; //!< First sample of each range -> LUXSim event
+    unsigned long fLuxSimEvtNumSize; //!< Number of samples covered by fLuxSimEvtNumbers
 
     std::vector<std::pair<unsigned int, unsigned int> > fPhotonIntervals;
     std::vector<bool> fOverlappingIntervals;
 
+    bool fHasBaseline; //!< True once digitised, see setBaseline()
+    double fBaseline; //!< [ADCC] Value of the samples outside the photon intervals
+    double fBaselineSigma; //!< [ADCC] Spread of those samples, 0 if noiseless
+
+    PulseSamples fOutputBuffer; //!< Scratch for stages that change the pulse length
+    bool fOutputSwapped; //!< True while fOutputBuffer holds the previous samples
+
 };
 
 #endif /* Pulse_hpp */
@@ -0,0 +1,40 @@
+//
+//  PulseMath.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef PulseMath_hpp
+#define PulseMath_hpp
+
+#include <stddef.h>
+
+/**
+ * Vectorised kernels for the arithmetic and reductions done on pulse samples.
+ *
+ * The kernels work on plain arrays, so they apply to Pulse, segments of a
+ * SegmentedPulse and any std::vector<double>. Pointers need not be aligned,
+ * but Pulse storage is 64-byte aligned so whole vectors are loaded from it.
+ * AVX is used when the build enables it, otherwise a portable version that
+ * compilers vectorise with SSE2. Both give bit-identical results: the sum is
+ * always accumulated in four interleaved lanes.
+ *
+ * findCrossing() also comes for the digitised samples [ADCC] of PODs and
+ * trigger responses, using SSE2 when available.
+ */
+
+namespace PulseMath
+{
+void add(double* a, const double* b, const size_t& n); //!< a += b
+void subtract(double* a, const double* b, const size_t& n); //!< a -= b
+void addScaled(double* a, const double* b, const double& scale, const size_t& n); //!< a += scale * b
+void scale(double* a, const double& scale, const size_t& n); //!< a *= scale
+void minMax(const double* a, const size_t& n, double& min, double& max);
+double sum(const double* a, const size_t& n);
+size_t findCrossing(const double* a, const size_t& n, const double& threshold, const bool& above = true);
+size_t findCrossing(const short* a, const size_t& n, const short& threshold, const bool& above = true);
+size_t findWithin(const double* a, const size_t& n, const double& centre, const double& halfWidth);
+}
+
+#endif /* PulseMath_hpp */
@@ -0,0 +1,48 @@
+//
+//  PulsePool.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef PulsePool_hpp
+#define PulsePool_hpp
+
+#include <memory>
+#include <stdio.h>
+#include <vector>
+
+#include "Pulse.hpp"
+
+/**
+ * Pool of Pulse buffers that are reused across channels and events.
+ *
+ * Every pulse held by the pool contains only zeros, so acquire() hands out
+ * a pulse that is ready to be filled without allocating or zero-filling
+ * the whole event window. On release() only the ranges that were written
+ * are zeroed again: the photon intervals, whose ends the devices extend
+ * over the filter tails. The full-length buffer of a digitised pulse is
+ * left clean by the Digitizer (see Pulse::getOutputBuffer()) and is simply
+ * swapped back.
+ *
+ * A pool is not thread safe; each worker should own one.
+ */
+
+class PulsePool
+{
+public:
+    PulsePool();
+    ~PulsePool();
+
+    std::shared_ptr<Pulse> acquire(const unsigned long& size);
+    void release(std::shared_ptr<Pulse>& thePulse);
+
+    size_t getNFree() const;
+    unsigned long long getNZeroedSamples() const;
+
+private:
+    std::vector<std::shared_ptr<Pulse>> fFree;
+    unsigned long long fNZeroedSamples; //!< Samples zeroed by release().
+};
+
+#endif /* PulsePool_hpp */
@@ -13,7 +13,9 @@
 #include <ctime>
 #include <random>
 #include <chrono>
+#include <map>
 
+#include "FlatPhotonInput.hpp"
 #include "RootInput.hpp"
 #include "PMT.hpp"
 
@@ -61,6 +63,7 @@ public:
     std::string getUserName();
     void getBaccObj();
     double getEventFirstPhotonTime(unsigned long long evt);
+    bool writeFlatPhotons(const std::string& path);
 #if (BACC_LIB_VERSION == 6)
     void getBaccObj(BaccMCTruthEvent**& BaccObj);
 #endif
@@ -76,14 +79,64 @@ protected:
     std::vector<std::vector<PMTStreamInfo>> EventAndPMTInfos;
     std::vector<int> nDataEntries;
 
-    int         determineDarkCounts(const unsigned long length, 
-                                    double darkCountRate);
+    bool readsEventPhotons() const;
+    void readEventPhotons(const unsigned long long& evt, PhotonPrefetcher::EventPhotons& thePhotons);
 
     unsigned long long fPreEventWindow;
     unsigned long long fPostEventWindow;
 
+    long long fPMTStreamCacheSize; //!< TTreeCache size per PMTStream chain [bytes]
+    unsigned int fNChannels; //!< Size of iPMTHits
+    std::vector<double> fPhotonTimeCut; //!< Per event, photon time [ns] after which photons are not read.
+    unsigned int fUnzipThreads; //!< Threads that unzip input baskets, 0 if they are unzipped when read
+
 #if (BACC_LIB_VERSION == 6)
-    PhotonMCTruth* pmthits;
+    /**
+     * Chain over all input files of the PMTStream tree of one PMT, with the
+     * branch address bound to hits.
+     */
+    struct PMTStream
+    {
+        TChain* chain;
+        PhotonMCTruth* hits;
+        bool split; //!< Whether PhotonMCTruth is split, so its times can be read alone.
+        TBranch* timeBranch; //!< fTime_ns sub-branch of the current tree.
+        int treeNumber; //!< Tree of the chain that timeBranch belongs to.
+        bool timesCached; //!< Whether the cache holds only fTime_ns rather than all members read.
+        std::vector<unsigned int> kept; //!< Photons of the event in the simulated window.
+    };
+
+    /**
+     * Result of the startup scan of MCTruthTree. It depends only on the input
+     * files, not on the DER settings, so it can be kept in an index file.
+     * The hit PMTs of event i, in increasing order, and their photons are
+     * hitPMT and hitPhotons from hitsBegin[i] to hitsBegin[i + 1].
+     */
+    struct EventIndex
+    {
+        unsigned int nChannels; //!< Size of iPMTHits
+        std::vector<double> firstPhotonTime; //[ns]
+        std::vector<double> lastPhotonTime; //[ns]
+        std::vector<double> parentTime; //[ns]
+        std::vector<double> referenceTime; //[ns]
+        std::vector<unsigned long long> hitsBegin;
+        std::vector<int> hitPMT;
+        std::vector<int> hitPhotons;
+    };
+
+    PMTStream& seekPMTStream(const PMTStreamInfo& info);
+    void cachePhotons(PMTStream& theStream, const long long& first, const long long& end, const bool& timesOnly);
+    void readPhotons(const PMTStreamInfo& info, const double& timeCut, PhotonPrefetcher::PhotonColumns& thePhotons);
+
+    void enableParallelUnzip(const unsigned int& nThreads);
+    void scanEvents(EventIndex& theIndex, const unsigned int& nThreads);
+    unsigned long long getInputChecksum() const;
+    std::string getEventIndexPath() const;
+    bool readEventIndex(const std::string& path, const unsigned long long& checksum, EventIndex& theIndex) const;
+    bool writeEventIndex(const std::string& path, const unsigned long long& checksum, const EventIndex& theIndex) const;
+
+    std::map<int, PMTStream> fPMTStreams; //!< PMTStream chains by PMT number
+    static std::map<std::string, std::pair<unsigned long long, EventIndex>> fResidentIndexes; //!< Indexes of this process by input files, with their checksums
     BaccMCTruthEvent* BaccObj;
 
 #endif
@@ -17,6 +17,7 @@
 #if (BACC_LIB_VERSION == 6)
 #include "BaccMCTruthEvent.hh"
 #include "DetectorMCTruthEvent.hpp"
+#include "FlatPhotonInput.hpp"
 #include "RootInputMDC2.hpp"
 #include "TChain.h"
 #include "TObject.h"
@@ -45,6 +46,7 @@ public:
     void doWriteEvent(EBEvent& theEBEvent); //!< Write event.
     void doWriteData(POD& theEBDataPOD,
         const int& DCID); //!< Write data.
+    void doWriteData(const PODArena& thePODs); //!< Write data of an event.
     void CloseFile(); //!< Close output file.
     void doPreparePulseMCTruth(
         unsigned long long NVertices,
@@ -63,6 +65,7 @@ protected:
     BaccMCTruthEvent** BaccObj;
     VertexMCTruth BaccVertex;
     DetectorMCTruthEvent* TruthObj;
+    FlatPhotonInput* FlatInput; //!< Flat photon input, if it is one.
 #endif
 
     struct PulseInfo
@@ -103,6 +106,7 @@ protected:
     std::vector<unsigned int> VertexCount;
 
     unsigned long DERevt;
+    unsigned long long SimEvt; //!< BACCARAT event of the DER event.
     unsigned short int DERRunIDIdx;
     unsigned char Origin;
     int NInteractionID; //!< Number of different interaction IDs possible.
@@ -10,10 +10,13 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <cstring>
 #include <ctime>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <set>
 #include <sstream>
@@ -34,6 +37,10 @@
 #include "InputOutputFormats.hpp"
 #include "OutputFactory.hpp"
 #include "PMT.hpp"
+#include "RootInputMDC2.hpp"
+#include "PODArena.hpp"
+#include "PulsePool.hpp"
+#include "Timeline.hpp"
 #include "FPGATrigger.hpp"
 #include "DeviceFactory.hpp"
 
@@ -42,11 +49,22 @@ const std::string GitHash = HASH;
 
 typedef std::vector<std::vector<std::shared_ptr<Device>>> DeviceVectors;
 typedef std::vector<std::vector<std::shared_ptr<Pulse>>> PulseVectors;
+typedef std::vector<std::vector<std::shared_ptr<SegmentedPulse>>> SegmentedPulseVectors;
 typedef std::vector<std::shared_ptr<PODContainer>> PODContainerVector;
 typedef std::vector<std::vector<std::shared_ptr<PODContainer>>> PODContainerVectors;
 
 namespace RunControl
 {
+/**
+ * Input files of one run of a batch and the directory its output is written
+ * to. An empty outDir uses the outDir setting.
+ */
+struct BatchJob
+{
+    std::vector<std::string> input_files;
+    std::string outDir;
+};
+
 /**
  * Function that displays help and usage.
  */
@@ -63,8 +81,8 @@ void displayHelp();
 bool toBool(const std::string& conf);
 void print_welcome_text();
 
-void parse_user_inputs(
-    int argc, char** argv, std::vector<std::string>& input_files, std::string& inFilename, global::ConfigPtr config);
+void parse_user_inputs(int argc, char** argv, std::vector<std::string>& input_files, std::string& inFilename,
+    std::string& flatOutput, std::string& batchList, std::string& serveSocket, global::ConfigPtr config);
 
 // int SetNumThreads(std::shared_ptr<DBInterface<std::string>> config);
 void set_number_of_threads(global::ConfigPtr config);
@@ -72,21 +90,42 @@ void set_random_number_seeds(std::string& random_seed, global::ConfigPtr config)
 void set_pmt_parameters(DBInterfaceFactory<double>& pmtParamsFactory, std::shared_ptr<DBInterface<double>> pmtCsvParams,
     global::ConfigPtr config);
 void set_trigger_parameters(global::ConfigPtr config);
-void acquire_and_process_data(
-    Input* input, Output* output, DDC32& testDCs, EBSummary* theEBSummary, global::ConfigPtr config);
+void acquire_and_process_data(Input* input, Output* output, DDC32& testDCs, EBSummary* theEBSummary,
+    global::ConfigPtr config, DeviceVectors& electronics, unsigned int firstDoubleGainStage);
+void acquire_continuous_timeline(Input* input, Output* output, DDC32& testDCs, EBSummary* theEBSummary,
+    global::ConfigPtr config, DeviceVectors& electronics, unsigned int firstDoubleGainStage,
+    unsigned long long timeShift);
 
 void do_analogue_electronics_response(DeviceVectors& electronics, Pulse& theLGPulse, Pulse& theHGPulse,
-				      PulseVectors& allStagePulses, unsigned int firstDoubleGainStage, bool fillStagePulses);
+				      SegmentedPulseVectors& allStagePulses, unsigned int firstDoubleGainStage,
+				      const std::vector<bool>& captureStages);
+
+void do_sparse_electronics_response(DeviceVectors& electronics, SegmentedPulse& theLGPulse, SegmentedPulse& theHGPulse,
+    unsigned int firstDoubleGainStage);
+
+unsigned long do_sliced_electronics_response(DeviceVectors& electronics, SlicedPulse& thePulse, PODContainer& theLGPODs,
+    PODContainer& theHGPODs, unsigned int firstDoubleGainStage, unsigned long sliceSamples);
+
+void do_timeline_electronics_response(DeviceVectors& electronics, Pulse& theLGPulse, Pulse& theHGPulse,
+    unsigned int firstDoubleGainStage, std::vector<double>& theLGResponse, std::vector<double>& theHGResponse);
 
 DeviceVectors setup_analogue_electronics(unsigned int& firstDoubleGainStage, global::ConfigPtr config);
-std::shared_ptr<PODContainer> create_pods(Pulse& thePulse, std::shared_ptr<MCTruth> theMCTruth, std::string gainOption, global::ConfigPtr config);
+void setup_noise_devices(DeviceVectors& electronics, global::ConfigPtr config);
+std::shared_ptr<PODContainer> create_pods(Pulse& thePulse, std::shared_ptr<MCTruth> theMCTruth, std::string gainOption,
+    global::ConfigPtr config, PODArena* arena = nullptr);
+std::shared_ptr<PODContainer> create_pods(SegmentedPulse& thePulse, std::shared_ptr<MCTruth> theMCTruth, std::string gainOption,
+    global::ConfigPtr config, PODArena* arena = nullptr);
 void run_trigger_on_pods(FPGATrigger& theTrigger, std::shared_ptr<PODContainer> thePODContainer, PODContainerVectors& allStagePODs);
-void create_stage_pods(PODContainerVectors& allStagePODs, PulseVectors& allStagePulses,
+void create_stage_pods(PODContainerVectors& allStagePODs, SegmentedPulseVectors& allStagePulses,
     std::shared_ptr<PODContainer>& thePODContainer, std::string gainOption, bool useS2Trigger);
 
 unsigned int build_event(
      PODContainerVector& thePODs, Output* output, PODContainerVectors& allStagePODs, global::ConfigPtr config);
+unsigned int build_event(PODArena& thePODs, Output* output);
+unsigned int write_timeline_event(PODArena& theLGPODs, PODArena& theHGPODs, Output* output,
+    const unsigned long long& liveStart, const unsigned long long& liveStop);
 
+std::set<unsigned int> parse_number_list(const std::string& list);
 std::string progress_status(const unsigned long long& it, const unsigned long& total);
 void print_info(unsigned long long& event, unsigned long long& NPhot, unsigned long& totalPhotons,
     unsigned int& numberOfLGPODs, unsigned int& numberOfHGPODs, std::vector<TStopwatch>& timers,
@@ -96,6 +135,11 @@ void set_data_collector_events(global::ConfigPtr config);
 void check_file_permissions(global::ConfigPtr config);
 void check_pmts_and_events(Input*& input, global::ConfigPtr config);
 void setup_input(Input*& input, std::vector<std::string>& input_files);
+format::revision get_input_format(const std::vector<std::string>& input_files);
+void convert_to_flat_photons(Input* input, const std::string& path);
+std::vector<BatchJob> read_batch_list(const std::string& path);
+std::string run_input_files(std::vector<std::string>& input_files, const std::string& derRandomSeed,
+    DeviceVectors& electronics, unsigned int firstDoubleGainStage, TStopwatch& timer, global::ConfigPtr config);
 void setup_output(Output*& output, format::revision formatVersion, bool& outputIsBinary, global::ConfigPtr config);
 
 void setup_time_stamp(Output*& output, unsigned long& realPosixTime, unsigned long& posixTime, std::string& localTime,
@@ -0,0 +1,101 @@
+//
+//  SegmentedPulse.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef SegmentedPulse_hpp
+#define SegmentedPulse_hpp
+
+#include <stdio.h>
+#include <utility>
+#include <vector>
+
+#include "Pulse.hpp"
+
+/**
+ * Sparse counterpart of Pulse that only stores the active parts of a
+ * channel's event window.
+ *
+ * A segmented pulse has a logical length like a dense pulse, but samples
+ * are only kept for segments: the photon intervals (as registered by
+ * addPhotonInterval) merged where they overlap and extended by the filter
+ * tails found by the devices. Everything between segments is a gap, which
+ * reads as a constant gap value with an optional Gaussian spread
+ * (the digitiser baseline and its noise) that is never materialised.
+ *
+ * Typical usage: register the intervals with addInterval(), call
+ * buildSegments(), then fill the segments through getSegment(). Sequential
+ * readers should use sample(), which is cheap for increasing indices. The
+ * dense form is available through fillDense() for debugging and for the
+ * raw data output.
+ */
+
+class SegmentedPulse
+{
+public:
+    struct Segment
+    {
+        unsigned long start; //!< First sample of the segment.
+        std::vector<double> samples;
+
+        unsigned long end() const
+        {
+            return start + samples.size();
+        }
+    };
+
+    SegmentedPulse();
+    ~SegmentedPulse();
+
+    void reset(const unsigned long& length, const double& gapValue = 0);
+
+    unsigned long size() const;
+    void setGapValue(const double& gapValue);
+    double getGapValue() const;
+    void setGapSigma(const double& gapSigma);
+    double getGapSigma() const;
+
+    void setChannel(unsigned int cn);
+    unsigned int getChannel() const;
+    void setEvent(const unsigned long long& evt);
+    unsigned long long getEvent() const;
+    void setLUXSimRunNumber(int run_number);
+    int getLUXSimRunNumber() const;
+    void setLUXSimEvtNum(const unsigned long long& sim);
+    unsigned long long getLUXSimEvtNum() const;
+
+    void addInterval(const unsigned long& start, const unsigned long& end);
+    void buildSegments();
+
+    size_t getNSegments() const;
+    Segment& getSegment(const size_t& i);
+    const Segment& getSegment(const size_t& i) const;
+    void setSegments(std::vector<Segment>& segments, const unsigned long& length);
+    size_t findSegment(const unsigned long& i) const;
+    void extendSegment(const size_t& i, const unsigned long& newEnd);
+    unsigned long getNStoredSamples() const;
+
+    double sample(const unsigned long& i) const;
+    double sample(const unsigned long& i, double& variance) const;
+
+    void assignTouched(const Pulse& thePulse);
+    void fillDense(Pulse& thePulse) const;
+
+private:
+    unsigned long fLength; //!< Logical number of samples.
+    double fGapValue; //!< Value of all samples outside segments.
+    double fGapSigma; //!< Spread of the gap samples, 0 if noiseless.
+
+    unsigned long long fEventID;
+    unsigned int fChannel; //!< PMT/Channel number
+    int fLuxSimRunNumber;
+    unsigned long long fLuxSimEvtNum; //!< LUXSim event of all samples.
+
+    std::vector<std::pair<unsigned long, unsigned long>> fIntervals; //!< Pending [start, end) intervals.
+    std::vector<Segment> fSegments; //!< Sorted, non-overlapping segments.
+    mutable size_t fCursor; //!< Last segment used by sample().
+};
+
+#endif /* SegmentedPulse_hpp */
@@ -0,0 +1,73 @@
+//
+//  Service.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef Service_hpp
+#define Service_hpp
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Resident DER that runs jobs sent over a local Unix socket.
+ *
+ * The caller sets up everything that is shared between runs once and gives
+ * the service a Runner that simulates one Job with it. A client connects,
+ * sends one request and reads one reply line, after which the connection is
+ * closed. A request is text, one field per line, ended by an empty line or
+ * by closing the sending side:
+ *
+ *     input /path/to/inputfile.root
+ *     outDir /path/to/output/
+ *     events 0-99,120
+ *     set Setting value
+ *
+ * input may be given more than once, the others are optional and set may be
+ * repeated. The reply is
+ *
+ *     OK <real time [s]> <CPU time [s]> <output file>
+ *     ERROR <message>
+ *
+ * A request of just "shutdown" stops the service. Jobs run one at a time, in
+ * the order the connections are accepted. The socket is only accessible to
+ * the user running the service.
+ */
+
+class Service
+{
+public:
+    struct Job
+    {
+        std::vector<std::string> input_files;
+        std::string outDir; //!< Empty for the outDir setting.
+        std::string events; //!< SelectedEvents, empty for the configured selection.
+        std::vector<std::pair<std::string, std::string>> overrides; //!< Settings changed for this job only.
+    };
+
+    /**
+     * Runs a job and returns the name of its output file. Throws if the job
+     * fails.
+     */
+    typedef std::function<std::string(const Job& theJob)> Runner;
+
+    Service(const std::string& socketPath, Runner theRunner);
+    ~Service();
+
+    void run();
+
+    static Job parseRequest(const std::string& request);
+
+private:
+    std::string handle(const std::string& request);
+
+    std::string fSocketPath;
+    Runner fRunner;
+    int fSocket; //!< Listening socket, -1 if closed.
+    bool fStop;
+};
+#endif /* Service_hpp */
@@ -0,0 +1,52 @@
+//
+//  SlicedPulse.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef SlicedPulse_hpp
+#define SlicedPulse_hpp
+
+#include <stdio.h>
+
+#include "Pulse.hpp"
+
+/**
+ * Pulse of which only a window of samples is held in memory, for processing
+ * a channel in time slices.
+ *
+ * A sliced pulse has a logical length and the photon intervals of a full
+ * pulse, but the samples stored in the underlying Pulse are those of the
+ * window [getWindowStart(), getWindowEnd()) only. Samples are addressed by
+ * their index in the full pulse through sample(). The window grows at the
+ * end with extendWindow() as a slice is filled, and is released from the
+ * front with discardBefore() once all stages are done with the samples.
+ */
+
+class SlicedPulse : public Pulse
+{
+public:
+    SlicedPulse();
+    ~SlicedPulse();
+
+    void reset(const unsigned long& length);
+
+    unsigned long getLength() const;
+    unsigned long getWindowStart() const;
+    unsigned long getWindowEnd() const;
+
+    double& sample(const unsigned long& i)
+    {
+        return (*this)[i - fWindowStart];
+    }
+
+    void extendWindow(const unsigned long& end);
+    void discardBefore(const unsigned long& start);
+
+private:
+    unsigned long fLength; //!< Number of samples of the full pulse
+    unsigned long fWindowStart; //!< Index of the first sample held
+};
+
+#endif /* SlicedPulse_hpp */
@@ -0,0 +1,80 @@
+//
+//  Timeline.hpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#ifndef Timeline_hpp
+#define Timeline_hpp
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "Buffer.hpp"
+#include "Digitizer.hpp"
+#include "PODArena.hpp"
+#include "PODContainer.hpp"
+
+/**
+ * Continuous acquisition of the responses of many events on one timeline.
+ *
+ * The sampled analogue response [mV] of a channel to an event, as given by
+ * Digitizer::decimateResponse(), is added to the timeline at the absolute
+ * sample at which the event happens. The chain is linear up to the ADC, so
+ * overlapping events simply add up. Each channel with a response is an
+ * island, whose LG and HG responses are held in ring buffers indexed by
+ * absolute sample. As the horizon advances with advance(), the samples
+ * before it are final: they are digitised with noise and streamed into a
+ * PODContainer per gain, which cuts the PODs into the arenas. An island is
+ * closed once the horizon is past its response and the POD windows after it,
+ * so memory is bounded by the channels that are active at the same time,
+ * not by the length of the timeline.
+ *
+ * Only the islands are digitised: the baseline noise between them is not
+ * drawn, so noise alone never forms a POD there.
+ *
+ * The PODs in the arenas have absolute start times in samples.
+ */
+
+class Timeline
+{
+public:
+    Timeline(std::shared_ptr<Digitizer> theDigitizer);
+    ~Timeline();
+
+    void addResponse(const unsigned int& pmtChannel, const unsigned long long& start,
+        const std::vector<double>& theLGResponse, const std::vector<double>& theHGResponse);
+    void advance(const unsigned long long& horizon, PODArena& theLGPODs, PODArena& theHGPODs);
+    void finish(PODArena& theLGPODs, PODArena& theHGPODs);
+
+    unsigned long long getHorizon() const;
+    size_t getNIslands() const;
+
+private:
+    struct Island
+    {
+        unsigned long long start; //!< First sample of the island.
+        unsigned long long next; //!< First sample not streamed yet.
+        unsigned long long end; //!< One past the last sample with a response.
+        Buffer<double> response[2]; //!< LG and HG response [mV].
+        std::shared_ptr<PODContainer> pods[2]; //!< LG and HG PODs.
+    };
+
+    Island& openIsland(const unsigned int& pmtChannel, const unsigned long long& start);
+    void reserve(Island& theIsland, const unsigned long long& first, const unsigned long long& end);
+    void stream(const unsigned int& pmtChannel, Island& theIsland, const unsigned long long& last,
+        PODArena* theArenas[2]);
+    void close(const unsigned int& pmtChannel, Island& theIsland, PODArena* theArenas[2]);
+
+    std::shared_ptr<Digitizer> fDigitizer;
+    std::map<unsigned int, std::unique_ptr<Island>> fIslands; //!< Open islands by PMT channel.
+    std::vector<std::unique_ptr<Island>> fSpareIslands; //!< Closed islands, kept for their buffers.
+    unsigned long long fHorizon; //!< Samples before this are final.
+    unsigned long long fLead; //!< Samples an island starts before its response.
+    unsigned long long fTail; //!< Samples an island is streamed after its response.
+    std::vector<double> fBlock; //!< Reused block of response samples [mV].
+    std::vector<double> fDigitized; //!< Reused block of digitised samples.
+};
+#endif /* Timeline_hpp */
@@ -622,6 +622,52 @@ void BinaryOutput::doWriteData(POD& theEBDataPOD, const int& DCID)
     }
 }
 
+void BinaryOutput::doWriteData(const PODArena& thePODs)
+{
+    /**
+     * Method that writes all PODs of an event to disk. The PODs of each DC
+     * are laid out as by doWriteData(POD&, const int&), but collected in a
+     * buffer and written with a single call per DC.
+     */
+    DCBuffer.resize(DC.size());
+    for (auto& buffer : DCBuffer)
+        buffer.clear();
+
+    for (size_t i = 0; i < thePODs.size(); ++i)
+    {
+        const PODArena::Descriptor& thePOD = thePODs.at(i);
+        const int DCID = thePOD.dataCollector;
+        if (DCID >= DC.size())
+        {
+            std::cout << "ERROR: Requested DC ID unavailable." << std::endl;
+            continue;
+        }
+
+        channel = thePOD.channel;
+        startTime = thePOD.start + trgTimeStamp;
+        nSamples = thePOD.length;
+
+        std::vector<char>& buffer = DCBuffer[DCID];
+        const char* samples = reinterpret_cast<const char*>(thePODs.getSamples(thePOD));
+        buffer.insert(buffer.end(), reinterpret_cast<const char*>(&channel),
+            reinterpret_cast<const char*>(&channel) + sizeof(uint16_t));
+        buffer.insert(buffer.end(), reinterpret_cast<const char*>(&startTime),
+            reinterpret_cast<const char*>(&startTime) + sizeof(uint64_t));
+        buffer.insert(buffer.end(), reinterpret_cast<const char*>(&nSamples),
+            reinterpret_cast<const char*>(&nSamples) + sizeof(uint16_t));
+        buffer.insert(buffer.end(), samples, samples + nSamples * sizeof(int16_t));
+
+        if (startTime < sumPODstartTS)
+            sumPODstartTS = startTime;
+        sumPODlength += nSamples;
+        nPods[DCID] += 1;
+    }
+
+    for (size_t i = 0; i < DC.size(); ++i)
+        if (!DCBuffer[i].empty())
+            fwrite(DCBuffer[i].data(), 1, DCBuffer[i].size(), DC[i].fd);
+}
+
 void BinaryOutput::doWriteEvent(EBEvent& theEBEvent)
 {
     /**
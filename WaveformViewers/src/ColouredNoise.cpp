@@ -0,0 +1,202 @@
+//
+//  ColouredNoise.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "ColouredNoise.hpp"
+
+ColouredNoise::ColouredNoise()
+    : fRMS(0)
+    , fSequencePos(0)
+{
+    /**
+     * Constructor for ColouredNoise.
+     */
+}
+
+ColouredNoise::ColouredNoise(const Spectrum& psd, const double& samplePeriod_ns, const size_t& bankSize)
+    : fPSD(psd)
+    , fRMS(0)
+    , fSequencePos(0)
+{
+    /**
+     * Constructor for ColouredNoise. Synthesises a bank of bankSize
+     * samples, rounded up to a power of 2, spaced by samplePeriod_ns.
+     */
+    std::sort(fPSD.begin(), fPSD.end());
+    generateBank(samplePeriod_ns, bankSize);
+}
+
+ColouredNoise::~ColouredNoise()
+{
+    /**
+     * Destructor for ColouredNoise.
+     */
+}
+
+std::map<int, ColouredNoise::Spectrum> ColouredNoise::readPSDFile(const std::string& path)
+{
+    /**
+     * Read PSD tables, keyed by channel, from a text file.
+     */
+    std::ifstream file(path);
+    if (!file.good())
+        throw std::runtime_error("ColouredNoise: cannot open PSD file " + path);
+
+    std::map<int, Spectrum> spectra;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream row(line);
+        int channel;
+        double frequency;
+        double psd;
+        if (!(row >> channel >> frequency >> psd))
+            continue;
+        if (frequency < 0 || psd < 0)
+            throw std::runtime_error("ColouredNoise: negative entry in PSD file " + path);
+        spectra[channel].push_back(std::make_pair(frequency, psd));
+    }
+
+    return spectra;
+}
+
+double ColouredNoise::interpolatePSD(const double& frequency) const
+{
+    /**
+     * Linear interpolation of the PSD table. Outside the measured range
+     * the closest measured value is used.
+     */
+    if (fPSD.empty())
+        return 0;
+    if (frequency <= fPSD.front().first)
+        return fPSD.front().second;
+    if (frequency >= fPSD.back().first)
+        return fPSD.back().second;
+
+    auto hi = std::lower_bound(fPSD.begin(), fPSD.end(), std::make_pair(frequency, 0.0));
+    auto lo = hi - 1;
+    double w = (frequency - lo->first) / (hi->first - lo->first);
+    return lo->second + w * (hi->second - lo->second);
+}
+
+void ColouredNoise::generateBank(const double& samplePeriod_ns, size_t bankSize)
+{
+    /**
+     * Each of the N complex bins k and N-k is weighted by
+     * sqrt(PSD(f_k) * df / 2), with f_k = k / (N * dt), and given a
+     * complex Gaussian amplitude. The real part of the transform is then
+     * a stationary, periodic noise series with the requested PSD and a
+     * variance equal to the PSD integrated up to the Nyquist frequency.
+     * The DC bin is left empty as the baseline is set by the DC offset.
+     */
+    size_t N = 1;
+    while (N < bankSize)
+        N <<= 1;
+
+    const double df = 1.0 / (N * samplePeriod_ns * 1e-9);
+
+    std::vector<double> weights(N / 2 + 1, 0);
+    double variance = 0;
+    for (size_t k = 1; k <= N / 2; ++k)
+    {
+        double power = interpolatePSD(k * df) * df;
+        weights[k] = std::sqrt(0.5 * power);
+        variance += (k == N / 2 ? 0.5 : 1.0) * power;
+    }
+    fRMS = std::sqrt(variance);
+
+    std::vector<double> spectrum;
+    GaussianNoise normal(1.0);
+    normal.fill(spectrum, 2 * N);
+    for (size_t k = 0; k < N; ++k)
+    {
+        double w = weights[std::min(k, N - k)];
+        spectrum[2 * k] *= w;
+        spectrum[2 * k + 1] *= w;
+    }
+
+    FFT transform;
+    transform.doComplexFFT(spectrum, kFALSE);
+
+    fBank.resize(N);
+    for (size_t i = 0; i < N; ++i)
+        fBank[i] = spectrum[2 * i];
+}
+
+void ColouredNoise::fill(std::vector<double>& noise, const size_t& n)
+{
+    /**
+     * Fill noise with n samples taken from the bank at a random offset.
+     * The bank is one period of the noise series, so wrapping around the
+     * end keeps the noise continuous.
+     */
+    noise.resize(n);
+    if (n == 0 || fBank.empty())
+    {
+        std::fill(noise.begin(), noise.end(), 0);
+        return;
+    }
+
+    const size_t bankSize = fBank.size();
+    size_t pos = gRandom->Integer(bankSize);
+    size_t done = 0;
+    while (done < n)
+    {
+        size_t len = std::min(n - done, bankSize - pos);
+        std::copy(fBank.begin() + pos, fBank.begin() + pos + len, noise.begin() + done);
+        done += len;
+        pos = 0;
+    }
+}
+
+void ColouredNoise::startSequence(const size_t& n)
+{
+    /**
+     * Start a sequence of n samples to be taken in pieces with fillNext(),
+     * identical to a single fill() of n samples.
+     */
+    if (n > 0 && !fBank.empty())
+        fSequencePos = gRandom->Integer(fBank.size());
+}
+
+void ColouredNoise::fillNext(std::vector<double>& noise, const size_t& n)
+{
+    noise.resize(n);
+    if (n == 0 || fBank.empty())
+    {
+        std::fill(noise.begin(), noise.end(), 0);
+        return;
+    }
+
+    const size_t bankSize = fBank.size();
+    size_t done = 0;
+    while (done < n)
+    {
+        size_t len = std::min(n - done, bankSize - fSequencePos);
+        std::copy(fBank.begin() + fSequencePos, fBank.begin() + fSequencePos + len, noise.begin() + done);
+        done += len;
+        fSequencePos = (fSequencePos + len) % bankSize;
+    }
+}
+
+double ColouredNoise::getRMS() const
+{
+    return fRMS;
+}
+
+size_t ColouredNoise::getBankSize() const
+{
+    return fBank.size();
+}
@@ -13,4 +13,11 @@ ConfigPtr create_default_config()
     config->setConfig(DER_ROOT + "/DERCONFIG.txt");
     return config;
 }
+
+std::string get_optional_config(const std::string& SID, const std::string& fallback)
+{
+    if (config && config->hasConfig(SID))
+        return config->getConfig(SID);
+    return fallback;
+}
 }
@@ -63,6 +63,168 @@ void Device::doResponse(Pulse& theLGPulse, Pulse& theHGPulse)
   doResponse(theHGPulse);
 }
 
+void Device::doResponse(SegmentedPulse& thePulse)
+{
+  // Same as the dense response: only the stored samples are filtered,
+  // and each segment is extended until the filter output settles.
+  for(size_t i = 0; i<thePulse.getNSegments(); ++i){
+    std::vector<double>& samples = thePulse.getSegment(i).samples;
+    for(size_t j = 0; j<samples.size(); ++j){
+      runFilters(samples[j]);
+    }
+    findBaseline(thePulse,i);
+  }
+  reset();
+}
+
+void Device::doResponse(SegmentedPulse& theLGPulse, SegmentedPulse& theHGPulse)
+{
+  doResponse(theLGPulse);
+  doResponse(theHGPulse);
+}
+
+void Device::startResponse(SlicedPulse& thePulse, SliceState& state)
+{
+  /**
+   * Prepare state for doResponse() on a sliced pulse whose photon
+   * intervals have all been registered.
+   */
+  state.phase = SliceState::kFilter;
+  state.interval = 0;
+  state.sample = (thePulse.getPhotonSize()>=1 ?
+		  thePulse.getPhotonIntervalAt(0).first : 0);
+  state.average = 0;
+}
+
+void Device::doResponse(SlicedPulse& thePulse, SliceState& state, const unsigned long& sampleLimit,
+			const unsigned int& intervalLimit)
+{
+  /**
+   * Same as the dense response, but only samples below sampleLimit and
+   * intervals below intervalLimit are used, which are those the previous
+   * stage is done with. The response stops where it needs more and carries
+   * on from there in the next call, so the result does not depend on the
+   * slicing.
+   */
+  const unsigned int avgSamples = 10;
+  unsigned int nIntervals = thePulse.getPhotonSize();
+  while(state.phase != SliceState::kDone){
+    switch(state.phase){
+    case SliceState::kFilter:
+      {
+	if(state.interval>=nIntervals){
+	  reset();
+	  state.phase = SliceState::kDone;
+	  break;
+	}
+	if(state.interval>=intervalLimit)
+	  return;
+	unsigned long end = std::min((unsigned long)thePulse.getPhotonIntervalAt(state.interval).second,
+				     thePulse.getLength());
+	for(; state.sample<end; ++state.sample){
+	  if(state.sample>=sampleLimit)
+	    return;
+	  runFilters(thePulse.sample(state.sample));
+	}
+	state.phase = SliceState::kBaselineStart;
+	break;
+      }
+    case SliceState::kBaselineStart:
+      if(state.sample>sampleLimit)
+	return;
+      state.phase = SliceState::kNextInterval;
+      if(state.sample>avgSamples){
+	state.average = 0;
+	for(unsigned int k = state.sample-avgSamples; k<state.sample; ++k){
+	  state.average += thePulse.sample(k);
+	}
+	state.average /= avgSamples;
+	state.phase = SliceState::kBaseline;
+      }
+      break;
+    case SliceState::kBaseline:
+      {
+	unsigned int& j = state.sample;
+	while(j<thePulse.getLength()-1){
+	  bool baselineFound = true;
+	  for(unsigned int k = j-avgSamples; k<j; ++k){
+	    if(std::abs(thePulse.sample(k)-state.average)>fHalfADCC/avgSamples) {
+	      baselineFound = false;
+	      break;
+	    }
+	  }
+	  if(baselineFound)
+	    break;
+	  if(j>=sampleLimit)
+	    return;
+	  runFilters(thePulse.sample(j));
+	  state.average -= thePulse.sample(j-avgSamples)/avgSamples;
+	  state.average += thePulse.sample(j)/avgSamples;
+	  ++j;
+	}
+	state.phase = SliceState::kNextInterval;
+	break;
+      }
+    case SliceState::kNextInterval:
+      if(!canFindNextFilterSample(thePulse, state, intervalLimit))
+	return;
+      thePulse.setPhotonIntervalEnd(state.interval,state.sample);
+      thePulse.findNextFilterSample(state.interval,state.sample);
+      ++state.interval;
+      state.phase = SliceState::kFilter;
+      break;
+    case SliceState::kDone:
+      break;
+    }
+  }
+}
+
+bool Device::canFindNextFilterSample(SlicedPulse& thePulse, const SliceState& state,
+				     const unsigned int& intervalLimit)
+{
+  /**
+   * Whether all intervals that Pulse::findNextFilterSample() would look at
+   * from the current one are below intervalLimit.
+   */
+  unsigned int nIntervals = thePulse.getPhotonSize();
+  unsigned int i = state.interval;
+  while(i+1<nIntervals){
+    if(i+1>=intervalLimit)
+      return false;
+    if(!thePulse.isIntervalOverlapping(i+1))
+      break;
+    ++i;
+  }
+  while(i+1<nIntervals){
+    if(i+1>=intervalLimit)
+      return false;
+    if(state.sample<=thePulse.getPhotonIntervalAt(i+1).second)
+      break;
+    ++i;
+  }
+  return true;
+}
+
+unsigned long Device::getSampleFrontier(const SlicedPulse& thePulse, const SliceState& state) const
+{
+  /**
+   * Samples below the frontier are not changed by this device any more.
+   */
+  if(state.phase == SliceState::kDone)
+    return thePulse.getLength();
+  return (state.sample>10 ? state.sample-10 : 0);
+}
+
+unsigned int Device::getIntervalFrontier(const SlicedPulse& thePulse, const SliceState& state) const
+{
+  /**
+   * Intervals below the frontier are not changed by this device any more.
+   */
+  if(state.phase == SliceState::kDone)
+    return thePulse.getPhotonSize();
+  return state.interval;
+}
+
 void Device::doStageResponse(Pulse& thePulse)
 {
 }
@@ -72,6 +234,10 @@ void Device::doStageResponse(Pulse& theLGPulse, Pulse& theHGPulse){
   doStageResponse(theHGPulse);
 }
 
+void Device::doStageResponse(SegmentedPulse& thePulse)
+{
+}
+
 void Device::prepareMCTruth(std::shared_ptr<MCTruth> theMCTruth)
 {
 }
@@ -113,3 +279,36 @@ void Device::findBaseline(Pulse& thePulse, unsigned int& j){
     }
   }
 }
+
+void Device::findBaseline(SegmentedPulse& thePulse, const size_t& segmentNo){
+  unsigned int avgSamples = 10;
+  SegmentedPulse::Segment* segment = &thePulse.getSegment(segmentNo);
+  if(segment->samples.size()>avgSamples){
+    bool baselineFound = false;
+    while(!baselineFound && segment->end()<thePulse.size()-1){
+      const std::vector<double>& samples = segment->samples;
+      size_t n = samples.size();
+      double average = 0;
+      for(size_t k = n-avgSamples; k<n; ++k){
+	average += samples[k];
+      }
+      average /= avgSamples;
+
+      baselineFound = true;
+      for(size_t k = n-avgSamples; k<n; ++k){
+	if(std::abs(samples[k]-average)>fHalfADCC/avgSamples) {
+	  baselineFound = false;
+	  break;
+	}
+      }
+      if(!baselineFound){
+	//grow by one sample, which may merge in the next segment
+	thePulse.extendSegment(segmentNo, segment->end()+1);
+	segment = &thePulse.getSegment(segmentNo);
+	for(size_t k = n; k<segment->samples.size(); ++k){
+	  runFilters(segment->samples[k]);
+	}
+      }
+    }
+  }
+}
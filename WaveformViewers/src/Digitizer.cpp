@@ -6,6 +6,7 @@
 //  Copyright © 2016 LZOxford. All rights reserved.
 //
 
+#include <stdexcept>
 #include <stdio.h>
 
 #include "Digitizer.hpp"
@@ -45,12 +46,22 @@ Digitizer::Digitizer(const der::DeviceModel& model)
     doNoiseAddition = true;
     baselineSigma = std::stod(global::config->getConfig("baselineSigma"));
     if(std::abs(baselineSigma)<0.01) doNoiseAddition = false;
+    fNoiseGenerator.setSigma(baselineSigma/fADCpermV);
+    // Optional pool of pre-generated noise for throughput-first runs,
+    // sampled at random offsets. 0 draws fresh noise for every pulse.
+    if(doNoiseAddition)
+      fNoiseGenerator.setBankSize(std::stoul(global::get_optional_config("NoiseBankSize", "0")));
 
-    if(sModel == der::DeviceModel::kSampled) 
-      doDownConvertPhotonIntervals = false;
-    else
-      doDownConvertPhotonIntervals = global::config->getConfig("WriteRawData")
-	                             == "true" ?  true : false;
+    // Coloured noise from measured spectra replaces the white baseline
+    // noise when a PSD file is configured.
+    doColouredNoise = false;
+    fDefaultSpectrum = 0;
+    std::string psdFile = global::get_optional_config("NoisePSDFile", "");
+    if(!psdFile.empty() && psdFile != "none")
+      setupColouredNoise(psdFile);
+
+    fSliceDigitizedSize = 0;
+    fSliceDigitized = 0;
 }
 
 Digitizer::~Digitizer()
@@ -72,30 +83,200 @@ void Digitizer::doResponse(Pulse& thePulse)
       Device::doResponse(thePulse);
     }
 
-  if(doDownConvertPhotonIntervals){
-    for(size_t i = 0; i<thePulse.getPhotonSize(); ++i){
-      thePulse.setPhotonIntervalStart(i, thePulse.getPhotonIntervalAt(i).first
-				      * (1.0 / (double)iSamplingInterval));
-      thePulse.setPhotonIntervalEnd(i, thePulse.getPhotonIntervalAt(i).second
-				    * (1.0 / (double)iSamplingInterval));
+  // Digitise into the pulse's output buffer rather than shrinking the
+  // pulse in place, so that the full-length buffer can be reused.
+  size_t digitizedSize = thePulse.size() * (1.0 / (double)iSamplingInterval);
+  PulseSamples& digitized = thePulse.getOutputBuffer();
+  digitized.resize(digitizedSize);
+  if(doNoiseAddition){
+    fillNoise(thePulse.getChannel(), digitizedSize);
+    for (size_t i = 0; i < digitizedSize; ++i)
+      {
+        digitized[i] = mVtoADC(thePulse[i * iSamplingInterval] + fDCOffset + fNoise[i]);
+      }
+  }
+  else{
+    for (size_t i = 0; i < digitizedSize; ++i)
+      {
+        digitized[i] = digitizePoint(thePulse[i * iSamplingInterval], false);
+      }
+  }
+
+  // The analogue response is only non-zero inside the photon intervals.
+  // Zero those so the full-length buffer is clean for PulsePool.
+  for(size_t i = 0; i<thePulse.getPhotonSize(); ++i){
+    size_t first = std::min((size_t)thePulse.getPhotonIntervalAt(i).first, thePulse.size());
+    size_t second = std::min((size_t)thePulse.getPhotonIntervalAt(i).second, thePulse.size());
+    if(first < second)
+      std::fill(thePulse.begin() + first, thePulse.begin() + second, 0.0);
+  }
+  thePulse.swapOutputBuffer();
+
+  // From here on the photon intervals are in digitised samples, as for
+  // segmented pulses: a sample is inside if the one it was taken from is.
+  // Outside them the pulse is the baseline.
+  for(size_t i = 0; i<thePulse.getPhotonSize(); ++i){
+    thePulse.setPhotonIntervalStart(i, (thePulse.getPhotonIntervalAt(i).first + iSamplingInterval - 1)
+				    / iSamplingInterval);
+    thePulse.setPhotonIntervalEnd(i, (thePulse.getPhotonIntervalAt(i).second + iSamplingInterval - 1)
+				  / iSamplingInterval);
+  }
+  thePulse.setBaseline(getBaseline(), getBaselineSigma(thePulse.getChannel()));
+}
+
+void Digitizer::doResponse(SegmentedPulse& thePulse)
+{
+  if (sModel == der::DeviceModel::kAnalytic)
+    {
+      Device::doResponse(thePulse);
+    }
+  downConvert(thePulse, doNoiseAddition);
+}
+
+void Digitizer::doStageResponse(SegmentedPulse& thePulse)
+{
+  downConvert(thePulse, false);
+}
+
+void Digitizer::downConvert(SegmentedPulse& thePulse, const bool& addNoise)
+{
+  // Keep the samples i*iSamplingInterval that fall inside a segment.
+  size_t digitizedSize = thePulse.size() * (1.0 / (double)iSamplingInterval);
+  std::vector<SegmentedPulse::Segment> digitized;
+  for(size_t s = 0; s<thePulse.getNSegments(); ++s){
+    const SegmentedPulse::Segment& segment = thePulse.getSegment(s);
+    unsigned long first = (segment.start + iSamplingInterval - 1) / iSamplingInterval;
+    unsigned long last = std::min((unsigned long)digitizedSize,
+				  (segment.end() + iSamplingInterval - 1) / iSamplingInterval);
+    if(first >= last) continue;
+    if(digitized.empty() || digitized.back().end() != first){
+      digitized.push_back(SegmentedPulse::Segment());
+      digitized.back().start = first;
     }
+    std::vector<double>& samples = digitized.back().samples;
+    for(unsigned long i = first; i<last; ++i)
+      samples.push_back(segment.samples[i * iSamplingInterval - segment.start]);
   }
 
+  for(auto& segment : digitized){
+    std::vector<double>& samples = segment.samples;
+    if(addNoise){
+      fillNoise(thePulse.getChannel(), samples.size());
+      for(size_t i = 0; i<samples.size(); ++i)
+	samples[i] = mVtoADC(samples[i] + fDCOffset + fNoise[i]);
+    }
+    else{
+      for(size_t i = 0; i<samples.size(); ++i)
+	samples[i] = mVtoADC(samples[i] + fDCOffset);
+    }
+  }
+
+  thePulse.setSegments(digitized, digitizedSize);
+  thePulse.setGapValue(mVtoADC(thePulse.getGapValue() + fDCOffset));
+  thePulse.setGapSigma(addNoise ? getBaselineSigma(thePulse.getChannel()) : 0);
+}
+
+void Digitizer::doStageResponse(Pulse& thePulse){
   size_t digitizedSize = thePulse.size() * (1.0 / (double)iSamplingInterval);
   for (size_t i = 0; i < digitizedSize; ++i)
     {
-      thePulse[i] = digitizePoint(thePulse[i * iSamplingInterval], true);
+      thePulse[i] = digitizePoint(thePulse[i * iSamplingInterval], false);
     }
   thePulse.resize(digitizedSize);
 }
 
-void Digitizer::doStageResponse(Pulse& thePulse){
+size_t Digitizer::startSlicedResponse(SlicedPulse& thePulse)
+{
+  /**
+   * Start digitising a sliced pulse with digitizeSlice(). The noise is
+   * drawn as for a single doResponse() on the whole pulse.
+   *
+   *\returns The length of the digitised pulse.
+   */
+  fSliceDigitizedSize = thePulse.getLength() * (1.0 / (double)iSamplingInterval);
+  fSliceDigitized = 0;
+  if(doNoiseAddition)
+    startNoiseSequence(thePulse.getChannel(), fSliceDigitizedSize);
+  return fSliceDigitizedSize;
+}
+
+void Digitizer::digitizeSlice(SlicedPulse& thePulse, const unsigned long& sampleLimit,
+			      std::vector<double>& digitized)
+{
+  /**
+   * Digitise the samples that were not digitised yet and are below
+   * sampleLimit, the frontier of the analogue response, into digitized.
+   */
+  size_t last = std::min(fSliceDigitizedSize,
+			 (size_t)((sampleLimit + iSamplingInterval - 1) / iSamplingInterval));
+  size_t n = (last > fSliceDigitized ? last - fSliceDigitized : 0);
+  digitized.resize(n);
+  if(doNoiseAddition){
+    fillNextNoise(thePulse.getChannel(), n);
+    for (size_t i = 0; i < n; ++i)
+      {
+	digitized[i] = mVtoADC(thePulse.sample((fSliceDigitized + i) * iSamplingInterval) + fDCOffset + fNoise[i]);
+      }
+  }
+  else{
+    for (size_t i = 0; i < n; ++i)
+      {
+	digitized[i] = digitizePoint(thePulse.sample((fSliceDigitized + i) * iSamplingInterval), false);
+      }
+  }
+  fSliceDigitized += n;
+}
+
+void Digitizer::decimateResponse(Pulse& thePulse, std::vector<double>& mV)
+{
+  /**
+   * Run the response of the digitiser up to the ADC and keep the analogue
+   * value [mV] of every sampled point in mV, without offset or noise. Up to
+   * here the chain is linear, so the values of overlapping pulses can be
+   * added before digitizeSamples() digitises them. The pulse is zeroed for
+   * PulsePool.
+   */
+  if (sModel == der::DeviceModel::kAnalytic)
+    {
+      Device::doResponse(thePulse);
+    }
+
   size_t digitizedSize = thePulse.size() * (1.0 / (double)iSamplingInterval);
+  mV.resize(digitizedSize);
   for (size_t i = 0; i < digitizedSize; ++i)
     {
-      thePulse[i] = digitizePoint(thePulse[i * iSamplingInterval], false);
+      mV[i] = thePulse[i * iSamplingInterval];
     }
-  thePulse.resize(digitizedSize);
+
+  for(size_t i = 0; i<thePulse.getPhotonSize(); ++i){
+    size_t first = std::min((size_t)thePulse.getPhotonIntervalAt(i).first, thePulse.size());
+    size_t second = std::min((size_t)thePulse.getPhotonIntervalAt(i).second, thePulse.size());
+    if(first < second)
+      std::fill(thePulse.begin() + first, thePulse.begin() + second, 0.0);
+  }
+}
+
+void Digitizer::digitizeSamples(const unsigned int& channel, const double* mV, const size_t& n,
+				std::vector<double>& digitized)
+{
+  /**
+   * Digitise n sampled points [mV] of the given channel, as doResponse()
+   * does after decimation. The noise is drawn afresh for each call.
+   */
+  digitized.resize(n);
+  if(doNoiseAddition){
+    fillNoise(channel, n);
+    for (size_t i = 0; i < n; ++i)
+      {
+	digitized[i] = mVtoADC(mV[i] + fDCOffset + fNoise[i]);
+      }
+  }
+  else{
+    for (size_t i = 0; i < n; ++i)
+      {
+	digitized[i] = digitizePoint(mV[i], false);
+      }
+  }
 }
 
 int Digitizer::digitizePoint(double mV, bool addNoise)
@@ -107,6 +288,30 @@ int Digitizer::digitizePoint(double mV, bool addNoise)
       return mVtoADC(mV);
 }
 
+double Digitizer::getBaseline()
+{
+    /**
+     * Digitised value of a sample without signal or noise [ADCC].
+     */
+    return mVtoADC(fDCOffset);
+}
+
+double Digitizer::getBaselineSigma(const unsigned int& channel) const
+{
+    /**
+     * Spread of the baseline noise of the channel [ADCC], 0 without noise.
+     */
+    return (doNoiseAddition ? getNoiseRMS(channel) * fADCpermV : 0);
+}
+
+bool Digitizer::hasBaselineNoise() const
+{
+    /**
+     * Whether baseline noise is added to the digitised samples.
+     */
+    return doNoiseAddition;
+}
+
 int Digitizer::mVtoADC(const double& mV)
 {
     /**
@@ -125,6 +330,79 @@ int Digitizer::mVtoADC(const double& mV)
     return round(fADCpermV * mV);
 }
 
+void Digitizer::setupColouredNoise(const std::string& psdFile)
+{
+  /**
+   * Build one noise bank per spectrum in psdFile. Banks are sampled at
+   * the DDC-32 sampling period of 10 ns.
+   */
+  std::map<int, ColouredNoise::Spectrum> spectra = ColouredNoise::readPSDFile(psdFile);
+  if(spectra.empty())
+    throw std::runtime_error("Digitizer: no spectra found in " + psdFile);
+
+  size_t bankSize = std::stoul(global::get_optional_config("ColouredNoiseBankSize", "65536"));
+  const double samplePeriod_ns = 10.0;
+
+  bool hasDefault = false;
+  for(auto& spectrum : spectra){
+    fColouredNoise.push_back(ColouredNoise(spectrum.second, samplePeriod_ns, bankSize));
+    if(spectrum.first < 0){
+      fDefaultSpectrum = fColouredNoise.size() - 1;
+      hasDefault = true;
+    }
+    else
+      fChannelSpectrum[spectrum.first] = fColouredNoise.size() - 1;
+  }
+  if(!hasDefault && fChannelSpectrum.size() > 1)
+    std::cout << "Digitizer: no default (channel -1) PSD, "
+              << "using the first spectrum for unlisted channels" << std::endl;
+
+  doColouredNoise = true;
+  doNoiseAddition = true;
+}
+
+void Digitizer::fillNoise(const unsigned int& channel, const size_t& n)
+{
+  if(!doColouredNoise){
+    fNoiseGenerator.fill(fNoise, n);
+    return;
+  }
+  auto it = fChannelSpectrum.find(channel);
+  size_t idx = (it == fChannelSpectrum.end() ? fDefaultSpectrum : it->second);
+  fColouredNoise[idx].fill(fNoise, n);
+}
+
+void Digitizer::startNoiseSequence(const unsigned int& channel, const size_t& n)
+{
+  if(!doColouredNoise){
+    fNoiseGenerator.startSequence(n);
+    return;
+  }
+  auto it = fChannelSpectrum.find(channel);
+  fColouredNoise[it == fChannelSpectrum.end() ? fDefaultSpectrum : it->second].startSequence(n);
+}
+
+void Digitizer::fillNextNoise(const unsigned int& channel, const size_t& n)
+{
+  if(!doColouredNoise){
+    fNoiseGenerator.fillNext(fNoise, n);
+    return;
+  }
+  auto it = fChannelSpectrum.find(channel);
+  fColouredNoise[it == fChannelSpectrum.end() ? fDefaultSpectrum : it->second].fillNext(fNoise, n);
+}
+
+double Digitizer::getNoiseRMS(const unsigned int& channel) const
+{
+  /**
+   * RMS [mV] of the noise added to the given channel.
+   */
+  if(!doColouredNoise)
+    return fNoiseGenerator.getSigma();
+  auto it = fChannelSpectrum.find(channel);
+  return fColouredNoise[it == fChannelSpectrum.end() ? fDefaultSpectrum : it->second].getRMS();
+}
+
 double Digitizer::addBaselineNoise(const double& mV){
     return mV + gRandom->Gaus(0, baselineSigma/fADCpermV);
 }
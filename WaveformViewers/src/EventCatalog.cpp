@@ -0,0 +1,265 @@
+//
+//  EventCatalog.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "EventCatalog.hpp"
+
+namespace
+{
+// One comparison of a cut, e.g. NPhotons >= 10
+struct Comparison
+{
+    std::string variable;
+    std::string op;
+    double value;
+};
+
+std::string trim(const std::string& s)
+{
+    size_t first = s.find_first_not_of(" \t");
+    if (first == std::string::npos)
+        return "";
+    return s.substr(first, s.find_last_not_of(" \t") - first + 1);
+}
+
+std::vector<std::string> split(const std::string& s, const std::string& delimiter)
+{
+    std::vector<std::string> parts;
+    size_t start = 0;
+    size_t pos = 0;
+    while ((pos = s.find(delimiter, start)) != std::string::npos)
+    {
+        parts.push_back(s.substr(start, pos - start));
+        start = pos + delimiter.size();
+    }
+    parts.push_back(s.substr(start));
+    return parts;
+}
+
+Comparison parseComparison(const std::string& term, const std::string& cut)
+{
+    static const char* ops[] = { "<=", ">=", "==", "!=", "<", ">" };
+    for (const char* op : ops)
+    {
+        size_t pos = term.find(op);
+        if (pos == std::string::npos)
+            continue;
+        Comparison theComparison;
+        theComparison.variable = trim(term.substr(0, pos));
+        theComparison.op = op;
+        std::string value = trim(term.substr(pos + theComparison.op.size()));
+        size_t end = 0;
+        try
+        {
+            theComparison.value = std::stod(value, &end);
+        }
+        catch (...)
+        {
+            end = 0;
+        }
+        if (end == 0 || end != value.size()
+            || (theComparison.variable != "NPhotons" && theComparison.variable != "NPMTs"
+                   && theComparison.variable != "TimeSpan"))
+            break;
+        return theComparison;
+    }
+    throw std::runtime_error("EventCatalog: Cannot parse \"" + trim(term) + "\" in the event cut \"" + cut + "\"");
+}
+
+bool passes(const Comparison& theComparison, const EventCatalog::Event& theEvent)
+{
+    double x = theEvent.timeSpan;
+    if (theComparison.variable == "NPhotons")
+        x = theEvent.nPhotons;
+    else if (theComparison.variable == "NPMTs")
+        x = theEvent.nPMTs;
+
+    if (theComparison.op == "<")
+        return x < theComparison.value;
+    if (theComparison.op == "<=")
+        return x <= theComparison.value;
+    if (theComparison.op == ">")
+        return x > theComparison.value;
+    if (theComparison.op == ">=")
+        return x >= theComparison.value;
+    if (theComparison.op == "==")
+        return x == theComparison.value;
+    return x != theComparison.value;
+}
+}
+
+EventCatalog::EventCatalog()
+{
+    /**
+     * Constructor for EventCatalog.
+     */
+}
+
+EventCatalog::~EventCatalog()
+{
+    /**
+     * Destructor for EventCatalog.
+     */
+}
+
+void EventCatalog::clear()
+{
+    fEvents.clear();
+    fAvailable.clear();
+    fEmpty.clear();
+    fSelected.clear();
+    fSelectedBefore.clear();
+    fNonEmptyBefore.clear();
+    fPhotonsBefore.clear();
+}
+
+void EventCatalog::addEvent(const unsigned long long& evt, const Event& theEvent, const bool& isEmpty)
+{
+    /**
+     * Add an available event to the catalog.
+     */
+    if (evt >= fEvents.size())
+    {
+        fEvents.resize(evt + 1, Event());
+        fAvailable.resize(evt + 1, false);
+        fEmpty.resize(evt + 1, false);
+    }
+    fEvents[evt] = theEvent;
+    fAvailable[evt] = true;
+    fEmpty[evt] = isEmpty;
+}
+
+void EventCatalog::select(const std::vector<unsigned long long>& theEvents)
+{
+    /**
+     * Set the selected events, which must be available, and build the prefix
+     * sums over them.
+     */
+    fSelected.assign(fEvents.size(), false);
+    for (const unsigned long long& evt : theEvents)
+    {
+        if (isAvailable(evt))
+            fSelected[evt] = true;
+    }
+
+    fSelectedBefore.assign(fEvents.size() + 1, 0);
+    fNonEmptyBefore.assign(fEvents.size() + 1, 0);
+    fPhotonsBefore.assign(fEvents.size() + 1, 0);
+    for (size_t i = 0; i < fEvents.size(); ++i)
+    {
+        bool selected = fSelected[i];
+        fSelectedBefore[i + 1] = fSelectedBefore[i] + selected;
+        fNonEmptyBefore[i + 1] = fNonEmptyBefore[i] + (selected && !fEmpty[i]);
+        fPhotonsBefore[i + 1] = fPhotonsBefore[i] + (selected ? fEvents[i].nPhotons : 0);
+    }
+}
+
+std::vector<unsigned long long> EventCatalog::applyCut(const std::string& cut,
+    const std::vector<unsigned long long>& theEvents) const
+{
+    /**
+     * Returns the events of theEvents that pass cut, in the same order. A cut
+     * is comparisons of NPhotons, NPMTs or TimeSpan [ns] with a number, joined
+     * by && and ||, where && binds tighter, e.g.
+     *
+     *     NPhotons >= 10 && TimeSpan < 1e6 || NPMTs > 100
+     *
+     * Throws if the cut cannot be parsed.
+     */
+    std::vector<std::vector<Comparison>> theAlternatives;
+    for (const std::string& alternative : split(cut, "||"))
+    {
+        std::vector<Comparison> theComparisons;
+        for (const std::string& term : split(alternative, "&&"))
+            theComparisons.push_back(parseComparison(term, cut));
+        theAlternatives.push_back(theComparisons);
+    }
+
+    std::vector<unsigned long long> thePassing;
+    for (const unsigned long long& evt : theEvents)
+    {
+        const Event& theEvent = at(evt);
+        bool pass = false;
+        for (const std::vector<Comparison>& theComparisons : theAlternatives)
+        {
+            pass = std::all_of(theComparisons.begin(), theComparisons.end(),
+                [&theEvent](const Comparison& theComparison) { return passes(theComparison, theEvent); });
+            if (pass)
+                break;
+        }
+        if (pass)
+            thePassing.push_back(evt);
+    }
+    return thePassing;
+}
+
+bool EventCatalog::isAvailable(const unsigned long long& evt) const
+{
+    return evt < fAvailable.size() && fAvailable[evt];
+}
+
+bool EventCatalog::isEmpty(const unsigned long long& evt) const
+{
+    return evt < fEmpty.size() && fEmpty[evt];
+}
+
+bool EventCatalog::isSelected(const unsigned long long& evt) const
+{
+    return evt < fSelected.size() && fSelected[evt];
+}
+
+const EventCatalog::Event& EventCatalog::at(const unsigned long long& evt) const
+{
+    return fEvents.at(evt);
+}
+
+unsigned long long EventCatalog::getNSelected() const
+{
+    return prefix(fSelectedBefore, fEvents.size());
+}
+
+unsigned long long EventCatalog::getNSelectedNonEmpty() const
+{
+    return prefix(fNonEmptyBefore, fEvents.size());
+}
+
+unsigned long long EventCatalog::countSelected(const unsigned long long& first, const unsigned long long& last) const
+{
+    /**
+     * Number of selected events in [first, last).
+     */
+    return prefix(fSelectedBefore, last) - prefix(fSelectedBefore, std::min(first, last));
+}
+
+unsigned long long EventCatalog::countSelectedNonEmpty(const unsigned long long& first,
+    const unsigned long long& last) const
+{
+    /**
+     * Number of selected non-empty events in [first, last).
+     */
+    return prefix(fNonEmptyBefore, last) - prefix(fNonEmptyBefore, std::min(first, last));
+}
+
+unsigned long long EventCatalog::countSelectedPhotons(const unsigned long long& first,
+    const unsigned long long& last) const
+{
+    /**
+     * Number of photons of the selected events in [first, last).
+     */
+    return prefix(fPhotonsBefore, last) - prefix(fPhotonsBefore, std::min(first, last));
+}
+
+unsigned long long EventCatalog::prefix(const std::vector<unsigned long long>& theSums,
+    const unsigned long long& evt) const
+{
+    if (theSums.empty())
+        return 0;
+    return theSums[std::min<unsigned long long>(evt, theSums.size() - 1)];
+}
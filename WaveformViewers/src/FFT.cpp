@@ -57,6 +57,18 @@ void FFT::ToPwr2(std::vector<double>& data)
     }
 }
 
+void FFT::PadToPwr2(std::vector<double>& data)
+{
+    /**
+     * Zero-pad the array to the next power of 2, so that callers do not
+     * need to size their data for the FFT.
+     */
+    unsigned long size2 = 1;
+    while (size2 < data.size())
+        size2 *= 2;
+    data.resize(size2, 0);
+}
+
 void FFT::BitReversal(std::vector<double>& data)
 {
     /**
@@ -254,6 +266,10 @@ void FFT::doRealFFT(Pulse& thePulse)
     for (int i = 0; i < N; ++i)
         x_arr[i] *= 1 - TMath::Cos(i * inc);
 
+    //The pulse itself is not padded, so pad the windowed copy here.
+    PadToPwr2(x_arr);
+    N = x_arr.size();
+
     RealFFT(x_arr, kFALSE);
 
     double freqBase(0);
@@ -264,7 +280,7 @@ void FFT::doRealFFT(Pulse& thePulse)
     unsigned long int fL = N / 2 - 1;
     freqBase = 1.0 / (TimeBase * N);
 
-    double* res = new double[N];
+    double* res = new double[N]();
     for (int i = 2; i < N; i += 2)
     {
         double fR2 = x_arr[i] * x_arr[i];
@@ -318,6 +334,15 @@ void FFT::doRealFFT(Pulse& thePulse)
     delete[] res;
 }
 
+void FFT::doComplexFFT(std::vector<double>& data, Bool_t forward)
+{
+    /**
+     * In-place complex FFT of interleaved (re, im) data. The number of
+     * complex points must be a power of 2. No normalisation is applied.
+     */
+    Fourier(data, forward);
+}
+
 void FFT::PlotFFT(const std::string& name,
     const std::string& evt,
     const std::string& channel,
@@ -7,11 +7,24 @@
 //
 
 #include <algorithm>
+#include <cmath>
+#include <deque>
+#include <queue>
+#include <random>
+#include <stdexcept>
 
 #include "FPGATrigger.hpp"
 #include "Config.hpp"
+#include "PulseMath.hpp"
 
-FPGATrigger::FPGATrigger(const std::string& model) : filterResponse(0), coincidenceRequirement(3), quietTime(1500000), holdOffTime(2500000)
+namespace
+{
+const short kDCOffset = 7372; //ADC baseline the filter works around
+const long long kFilterScale = 2; //A and B are multiples of 1/kFilterScale
+const size_t kFilterChunk = 4096; //Samples of a POD filtered at a time
+}
+
+FPGATrigger::FPGATrigger(const std::string& model) : previousFilteredIndex(0), filterResponse(0), coincidenceRequirement(3), quietTime(1500000), holdOffTime(2500000), streamStarted(false), streamFirstSample(0), nTriggerPoints(0)
 {
   if (model.find("S1") != std::string::npos)
     { //S1
@@ -31,6 +44,24 @@ FPGATrigger::FPGATrigger(const std::string& model) : filterResponse(0), coincide
       threshold = (model.find("LG") != std::string::npos ? 10000 : 30000); 
       coincidenceWindow = (model.find("LG") != std::string::npos ? 60 : 80); 
     }
+
+  //Fixed point filter weights, as used by filterSamples()
+  weightA = std::llround(A * kFilterScale);
+  weightB = std::llround(B * kFilterScale);
+  if (weightA != A * kFilterScale || weightB != B * kFilterScale)
+    throw std::invalid_argument("FPGATrigger: filter weights of model " + model + " are not multiples of 1/2");
+  filterN = n;
+  filterM = m;
+  //A short response is above threshold if it is above its integer part
+  sampleThreshold = (short)std::max(-32768.0, std::min(32767.0, std::floor(threshold)));
+  checkFilter = (global::get_optional_config("TriggerFilterCheck", "false") == "true");
+
+  //The trigger types of the model: channels with a trigger point within the
+  //coincidence window and, for S2, the summed response of those points,
+  //needing as much as coincidenceRequirement points at threshold
+  addTriggerType({ model, kMultiplicity, coincidenceWindow, (double)coincidenceRequirement });
+  if (model.find("S2") != std::string::npos)
+    addTriggerType({ model + "Sum", kSum, coincidenceWindow, coincidenceRequirement * (threshold - kDCOffset) });
 }
 
 FPGATrigger::~FPGATrigger()
@@ -78,22 +109,144 @@ double FPGATrigger::calculateFilterResponse(std::shared_ptr<POD> thePOD, const s
   return filterResponse;
 }
 
+void FPGATrigger::startFilterStream()
+{
+  /**
+   * Start filtering a new stream of samples, such as a POD, with
+   * filterSamples().
+   */
+  streamStarted = false;
+  streamFirstSample = 0;
+  streamSums.assign(2 * filterN + filterM, 0); //no samples before the stream
+}
+
+void FPGATrigger::filterSamples(const short* samples, const size_t nSamples, short* response)
+{
+  /**
+   * Filter the next nSamples samples of the stream into response, with the
+   * DC offset reapplied. The result is that of calculateFilterResponse()
+   * called on the samples in order, cast to short as processPOD() does.
+   *
+   * With S(i) the sum of the samples (less the DC offset) up to i, the
+   * response at i is
+   *   B (S(i) - S(i-2n-m) - x0) + (A + B) (S(i-n-m) - S(i-n)),
+   * where x0 is the first sample, whose response the reference sets to 0.
+   * The running sums of a chunk are formed first, after which every sample
+   * of the chunk is independent so the loop is vectorised. Between chunks
+   * only the last 2n+m sums are kept.
+   */
+  if (nSamples == 0)
+    return;
+  if (!streamStarted)
+  {
+    streamFirstSample = (long long)samples[0] - kDCOffset;
+    streamStarted = true;
+  }
+
+  const ptrdiff_t history = 2 * filterN + filterM;
+  streamSums.resize(history + nSamples);
+  long long* sums = streamSums.data() + history;
+  long long runningSum = (history > 0 ? sums[-1] : 0);
+  for (size_t i = 0; i < nSamples; ++i)
+  {
+    runningSum += (long long)samples[i] - kDCOffset;
+    sums[i] = runningSum;
+  }
+
+  const long long outerWeight = weightB;
+  const long long innerWeight = weightA + weightB;
+  const long long firstSample = streamFirstSample;
+  const ptrdiff_t n = filterN;
+  const ptrdiff_t nm = filterN + filterM;
+  for (ptrdiff_t i = 0; i < (ptrdiff_t)nSamples; ++i)
+  {
+    long long scaled = outerWeight * (sums[i] - sums[i - history] - firstSample)
+        + innerWeight * (sums[i - nm] - sums[i - n]);
+    response[i] = (short)((short)(scaled / kFilterScale) + kDCOffset);
+  }
+
+  //Keep the running sums the next chunk needs
+  streamSums.erase(streamSums.begin(), streamSums.end() - history);
+}
+
+void FPGATrigger::checkFilterStream()
+{
+  /**
+   * Compare filterSamples(), fed in chunks of varying size, with
+   * calculateFilterResponse() on a fixed stream of baseline noise and
+   * pulses, and throw at the first difference. Cheap enough to run once
+   * per model at the start of a run.
+   */
+  std::minstd_rand rng(20180213);
+  std::shared_ptr<POD> thePOD(new POD());
+  thePOD->resize(4 * kFilterChunk + 123);
+  double pulse = 0;
+  for (size_t i = 0; i < thePOD->size(); ++i)
+    {
+      if (rng() % 500 == 0)
+        pulse += rng() % 9000;
+      pulse *= 0.95;
+      double sample = kDCOffset + pulse + (double)(rng() % 7) - 3;
+      thePOD->at(i) = (short)std::min(16383.0, sample);
+    }
+
+  std::vector<short> response(thePOD->size());
+  startFilterStream();
+  for (size_t first = 0; first < thePOD->size();)
+    {
+      //Chunks shorter than the filter as well as longer than a POD chunk
+      size_t longest = (rng() % 2 == 0 ? 2 * kFilterChunk : 64);
+      size_t chunk = std::min((size_t)(1 + rng() % longest), thePOD->size() - first);
+      filterSamples(thePOD->data() + first, chunk, response.data() + first);
+      first += chunk;
+    }
+  for (size_t i = 0; i < thePOD->size(); ++i)
+    {
+      short reference = (short)calculateFilterResponse(thePOD,i)+kDCOffset;
+      if (reference != response[i])
+        throw std::runtime_error("FPGATrigger: streamed filter response " + std::to_string(response[i]) + " at sample " + std::to_string(i) + " differs from the reference " + std::to_string(reference));
+    }
+  resetPODParameters();
+}
+
 std::shared_ptr<POD> FPGATrigger::processPOD(std::shared_ptr<POD> thePOD)
 {
-  short DCOffset = 7372;
   std::shared_ptr<POD> theTriggerPOD(new POD());
   theTriggerPOD->resize(thePOD->size());
   theTriggerPOD->setPODLength(thePOD->size());
   theTriggerPOD->setHitID(thePOD->getHitID());
-  for (size_t i = 0; i < thePOD->size(); ++i)
+  //reapply the DC offset so that we can view this on the PODViewer
+  startFilterStream();
+  const short* response = theTriggerPOD->data();
+  const size_t size = theTriggerPOD->size();
+  const unsigned int channel = thePOD->getChannel();
+  for (size_t first = 0; first < size; first += kFilterChunk)
     {
-      short response = (short)calculateFilterResponse(thePOD,i)+DCOffset; //reapply the DC offset so that we can view this on the PODViewer
-      theTriggerPOD->at(i) = response;
-      if(response>threshold){
-        thePOD->setIsTriggered(true);
-        thePOD->setTriggeredSample(i);
-	triggeredTimeStamps.push_back(thePOD->getTriggeredTimeStamp());
-      }
+      const size_t last = std::min(size, first + kFilterChunk);
+      filterSamples(thePOD->data() + first, last - first, theTriggerPOD->data() + first);
+      if (checkFilter)
+        {
+          for (size_t i = first; i < last; ++i)
+            {
+              short reference = (short)calculateFilterResponse(thePOD,i)+kDCOffset;
+              if (reference != theTriggerPOD->at(i))
+                throw std::runtime_error("FPGATrigger: filter response " + std::to_string(theTriggerPOD->at(i)) + " at sample " + std::to_string(i) + " of channel " + std::to_string(thePOD->getChannel()) + " differs from the reference " + std::to_string(reference));
+            }
+        }
+
+      for (size_t i = first + PulseMath::findCrossing(response + first, last - first, sampleThreshold); i < last; i += 1 + PulseMath::findCrossing(response + i + 1, last - i - 1, sampleThreshold))
+        {
+          thePOD->setIsTriggered(true);
+          thePOD->setTriggeredSample(i);
+          const TriggerPoint thePoint = { thePOD->getTriggeredTimeStamp(), channel, response[i] - kDCOffset };
+          //A point earlier than the last of its channel starts a new list, so
+          //that every list is in time order without being sorted
+          if (channelTriggerPoints.empty() || channelTriggerPoints.back().channel != channel
+              || channelTriggerPoints.back().points.back().time > thePoint.time)
+            channelTriggerPoints.push_back({ channel, std::vector<TriggerPoint>() });
+          channelTriggerPoints.back().points.push_back(thePoint);
+          ++nTriggerPoints;
+        }
     }
   resetPODParameters();
   return theTriggerPOD;
@@ -117,14 +270,18 @@ size_t FPGATrigger::getTriggeredChannelsSize()
 
 std::vector<unsigned long long>& FPGATrigger::getTriggerPoints()
 {
-  if(triggeredTimeStamps.size()>coincidenceRequirement){
-    std::sort(triggeredTimeStamps.begin(), triggeredTimeStamps.end());
-    unsigned long long previousPoint = triggeredTimeStamps.at(0);
+  if(nTriggerPoints>coincidenceRequirement){
+    bool first = true;
+    unsigned long long previousPoint = 0;
     unsigned long long triggerResumeTime = 0;
     unsigned int coincidence = 0;
-    for(size_t i = 1; i<triggeredTimeStamps.size(); ++i){
-      if(triggeredTimeStamps[i]>triggerResumeTime){
-	if(triggeredTimeStamps[i]-previousPoint < coincidenceWindow)
+    mergeTriggerPoints([&](const TriggerPoint& thePoint){
+      if(first){
+	previousPoint = thePoint.time;
+	first = false;
+      }
+      else if(thePoint.time>triggerResumeTime){
+	if(thePoint.time-previousPoint < coincidenceWindow)
 	  ++coincidence;
 	else{
 	  if(coincidence >= coincidenceRequirement){ //triggered
@@ -132,14 +289,112 @@ std::vector<unsigned long long>& FPGATrigger::getTriggerPoints()
 	    //triggerResumeTime = previousPoint + quietTime + holdOffTime; //do not trigger again for a certain amount of time
 	  }
 	  coincidence = 0;
-	  previousPoint = triggeredTimeStamps[i];
+	  previousPoint = thePoint.time;
 	}
       }
-    }
+    });
   }
   return eventTriggerPoints;
 } 
 
+size_t FPGATrigger::addTriggerType(const TriggerType& type)
+{
+  /**
+   * Add a trigger type to be evaluated by buildEventTriggers() and return
+   * its index. The types of the model are added by the constructor.
+   */
+  triggerTypes.push_back(type);
+  return triggerTypes.size() - 1;
+}
+
+const std::vector<FPGATrigger::TriggerType>& FPGATrigger::getTriggerTypes() const
+{
+  return triggerTypes;
+}
+
+const std::vector<FPGATrigger::EventTrigger>& FPGATrigger::buildEventTriggers()
+{
+  /**
+   * Evaluate all trigger types in one pass over the trigger points of the
+   * event, as they leave the heap in time order. For each type a window
+   * holds the points less than its window before the latest one, with a
+   * running count of the channels in it and sum of their responses. A type
+   * triggers at the point with which its multiplicity or sum reaches the
+   * requirement, and is re-armed once it drops below it again.
+   */
+  struct WindowState
+  {
+    std::deque<TriggerPoint> points;
+    std::vector<unsigned int> channelCounts; //Points per channel in the window
+    double value; //Multiplicity or sum
+    bool armed;
+  };
+
+  eventTriggers.clear();
+  std::vector<WindowState> states(triggerTypes.size(), WindowState{ std::deque<TriggerPoint>(), std::vector<unsigned int>(), 0, true });
+  mergeTriggerPoints([&](const TriggerPoint& thePoint){
+    for (size_t t = 0; t < triggerTypes.size(); ++t)
+    {
+      const TriggerType& theType = triggerTypes[t];
+      WindowState& theState = states[t];
+      const bool multiplicity = (theType.kind == kMultiplicity);
+
+      while (!theState.points.empty() && thePoint.time - theState.points.front().time >= theType.window)
+      {
+        const TriggerPoint& theOldPoint = theState.points.front();
+        if (multiplicity)
+          theState.value -= (--theState.channelCounts[theOldPoint.channel] == 0);
+        else
+          theState.value -= theOldPoint.response;
+        theState.points.pop_front();
+      }
+
+      theState.points.push_back(thePoint);
+      if (multiplicity)
+      {
+        if (theState.channelCounts.size() <= thePoint.channel)
+          theState.channelCounts.resize(thePoint.channel + 1, 0);
+        theState.value += (theState.channelCounts[thePoint.channel]++ == 0);
+      }
+      else
+        theState.value += thePoint.response;
+
+      if (theState.value >= theType.requirement)
+      {
+        if (theState.armed)
+          eventTriggers.push_back({ thePoint.time, t, theState.value });
+        theState.armed = false;
+      }
+      else
+        theState.armed = true;
+    }
+  });
+  return eventTriggers;
+}
+
+void FPGATrigger::mergeTriggerPoints(const std::function<void(const TriggerPoint&)>& visit)
+{
+  /**
+   * Visit the trigger points of all channels in time order, taking them
+   * from the time ordered list of each channel with a heap over the lists.
+   */
+  typedef std::pair<unsigned long long, size_t> HeapEntry; //time, channel list
+  std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > heap;
+  std::vector<size_t> next(channelTriggerPoints.size(), 0);
+  for (size_t c = 0; c < channelTriggerPoints.size(); ++c)
+    heap.push(HeapEntry(channelTriggerPoints[c].points[0].time, c));
+
+  while (!heap.empty())
+  {
+    const size_t c = heap.top().second;
+    heap.pop();
+    const std::vector<TriggerPoint>& points = channelTriggerPoints[c].points;
+    visit(points[next[c]]);
+    if (++next[c] < points.size())
+      heap.push(HeapEntry(points[next[c]].time, c));
+  }
+}
+
 bool FPGATrigger::isPossibleForTrigger(){
   return (triggeredChannels.size() >= coincidenceRequirement ? true : false);
 }
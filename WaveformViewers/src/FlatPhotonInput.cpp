@@ -0,0 +1,400 @@
+//
+//  FlatPhotonInput.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "FlatPhotonInput.hpp"
+
+static_assert(sizeof(FlatPhotonInput::Header) == 112, "Unexpected size of FlatPhotonInput::Header");
+static_assert(sizeof(FlatPhotonInput::EventEntry) == 56, "Unexpected size of FlatPhotonInput::EventEntry");
+static_assert(sizeof(FlatPhotonInput::PMTEntry) == 16, "Unexpected size of FlatPhotonInput::PMTEntry");
+
+const char FlatPhotonInput::kMagic[8] = { 'D', 'E', 'R', 'F', 'L', 'A', 'T', '\0' };
+const std::uint32_t FlatPhotonInput::kVersion = 1;
+
+namespace
+{
+std::uint64_t align8(const std::uint64_t& offset)
+{
+    return (offset + 7) & ~std::uint64_t(7);
+}
+
+void adviseWillNeed(const void* first, const size_t& bytes)
+{
+    // madvise() needs a page aligned start
+    static const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)first & ~(pageSize - 1);
+    uintptr_t end = (uintptr_t)first + bytes;
+    if (bytes > 0)
+        madvise((void*)start, end - start, MADV_WILLNEED);
+}
+}
+
+FlatPhotonInput::Header FlatPhotonInput::makeHeader(const std::uint32_t& nChannels, const std::uint64_t& nEvents,
+    const std::uint64_t& nPMTs, const std::uint64_t& nPhotons, const std::uint64_t& userNameLength)
+{
+    /**
+     * Returns the header of a file of the given size, with the offsets of
+     * the sections.
+     */
+    Header theHeader;
+    std::memset(&theHeader, 0, sizeof(theHeader));
+    std::memcpy(theHeader.magic, kMagic, sizeof(kMagic));
+    theHeader.version = kVersion;
+    theHeader.nChannels = nChannels;
+    theHeader.nEvents = nEvents;
+    theHeader.nPMTs = nPMTs;
+    theHeader.nPhotons = nPhotons;
+    theHeader.userNameLength = userNameLength;
+    theHeader.eventsOffset = align8(sizeof(Header));
+    theHeader.pmtsOffset = align8(theHeader.eventsOffset + nEvents * sizeof(EventEntry));
+    theHeader.timeOffset = align8(theHeader.pmtsOffset + nPMTs * sizeof(PMTEntry));
+    theHeader.wavelengthOffset = align8(theHeader.timeOffset + nPhotons * sizeof(double));
+    theHeader.interactionIDOffset = align8(theHeader.wavelengthOffset + nPhotons * sizeof(double));
+    theHeader.vertexNumberOffset = align8(theHeader.interactionIDOffset + nPhotons * sizeof(std::int32_t));
+    theHeader.pulseIDOffset = align8(theHeader.vertexNumberOffset + nPhotons * sizeof(std::int32_t));
+    theHeader.userNameOffset = align8(theHeader.pulseIDOffset + nPhotons * sizeof(std::int32_t));
+    return theHeader;
+}
+
+FlatPhotonInput::FlatPhotonInput()
+    : fPreEventWindow(0)
+    , fPostEventWindow(0)
+    , fMapped(nullptr)
+    , fMappedSize(0)
+    , fHeader(nullptr)
+    , fEvents(nullptr)
+    , fPMTs(nullptr)
+    , fTime(nullptr)
+    , fWavelength(nullptr)
+    , fInteractionID(nullptr)
+    , fVertexNumber(nullptr)
+    , fPulseID(nullptr)
+{
+    /**
+     * Constructor for FlatPhotonInput.
+     */
+    LZ_PMT_Numbering_Revision = format::LZ_ICD_08_0008::Rev_Ap1;
+    data = NULL;
+}
+
+FlatPhotonInput::~FlatPhotonInput()
+{
+    /**
+     * Destructor for FlatPhotonInput.
+     */
+    Close();
+}
+
+TFile* FlatPhotonInput::getFilePointer()
+{
+    /**
+     * There is no ROOT file.
+     */
+    return NULL;
+}
+
+bool FlatPhotonInput::Open()
+{
+    /**
+     * Map the flat photon file given by filePath and check its header and
+     * that its sections are within the file.
+     */
+    if (filePath.size() != 1)
+    {
+        std::cout << "ERROR: The flat photon input reads one file, " << filePath.size() << " were given"
+                  << std::endl;
+        return false;
+    }
+
+    int fd = open(filePath[0].c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cout << "ERROR: Cannot find file " << filePath[0] << std::endl;
+        return false;
+    }
+    struct stat theStat;
+    if (fstat(fd, &theStat) != 0 || (size_t)theStat.st_size < sizeof(Header))
+    {
+        std::cout << "ERROR: Cannot open file " << filePath[0] << std::endl;
+        close(fd);
+        return false;
+    }
+    void* theMap = mmap(nullptr, theStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (theMap == MAP_FAILED)
+    {
+        std::cout << "ERROR: Cannot map file " << filePath[0] << std::endl;
+        return false;
+    }
+    fMapped = (const char*)theMap;
+    fMappedSize = theStat.st_size;
+    fHeader = (const Header*)fMapped;
+
+    auto inFile = [this](const std::uint64_t& offset, const std::uint64_t& n, const size_t& size) {
+        return offset % 8 == 0 && offset <= fMappedSize && n <= (fMappedSize - offset) / size;
+    };
+    if (std::memcmp(fHeader->magic, kMagic, sizeof(kMagic)) != 0 || fHeader->version != kVersion
+        || !inFile(fHeader->eventsOffset, fHeader->nEvents, sizeof(EventEntry))
+        || !inFile(fHeader->pmtsOffset, fHeader->nPMTs, sizeof(PMTEntry))
+        || !inFile(fHeader->timeOffset, fHeader->nPhotons, sizeof(double))
+        || !inFile(fHeader->wavelengthOffset, fHeader->nPhotons, sizeof(double))
+        || !inFile(fHeader->interactionIDOffset, fHeader->nPhotons, sizeof(std::int32_t))
+        || !inFile(fHeader->vertexNumberOffset, fHeader->nPhotons, sizeof(std::int32_t))
+        || !inFile(fHeader->pulseIDOffset, fHeader->nPhotons, sizeof(std::int32_t))
+        || !inFile(fHeader->userNameOffset, fHeader->userNameLength, sizeof(char)))
+    {
+        std::cout << "ERROR: " << filePath[0] << " is not a flat photon file of version " << kVersion << std::endl;
+        Close();
+        return false;
+    }
+    fEvents = (const EventEntry*)(fMapped + fHeader->eventsOffset);
+    fPMTs = (const PMTEntry*)(fMapped + fHeader->pmtsOffset);
+    fTime = (const double*)(fMapped + fHeader->timeOffset);
+    fWavelength = (const double*)(fMapped + fHeader->wavelengthOffset);
+    fInteractionID = (const std::int32_t*)(fMapped + fHeader->interactionIDOffset);
+    fVertexNumber = (const std::int32_t*)(fMapped + fHeader->vertexNumberOffset);
+    fPulseID = (const std::int32_t*)(fMapped + fHeader->pulseIDOffset);
+    std::cout << "File Opened:\t" << filePath[0] << std::endl;
+    return true;
+}
+
+void FlatPhotonInput::Close()
+{
+    /**
+     * Unmap the file.
+     */
+    stopPrefetch();
+    if (fMapped)
+        munmap((void*)fMapped, fMappedSize);
+    fMapped = nullptr;
+    fMappedSize = 0;
+    fHeader = nullptr;
+}
+
+int FlatPhotonInput::makePMTDataReady()
+{
+    /**
+     * Returns -1 if error, 0 if ok.
+     *
+     * Finds the PMTs of each event from the event directory and draws their
+     * dark counts, as RootInputMDC2 does from its event index.
+     */
+    std::cout << "Preparing input file..." << std::endl;
+    unsigned long long N = fHeader->nEvents;
+    fEventPMTs.assign(N, std::vector<PMTInfo>());
+    fEventNPhotons.assign(N, 0);
+    AllEventFirstPhotonTimes_ns.resize(N);
+    fPreEventWindow = std::stoull(global::config->getConfig("PreEventWindow"));
+    fPostEventWindow = std::stoull(global::config->getConfig("PostEventWindow"));
+
+    std::vector<bool> isAvailable(fHeader->nChannels, false);
+    for (unsigned long long i = 0; i < N; i++)
+    {
+        const EventEntry& theEvent = fEvents[i];
+        if (theEvent.firstPMT > fHeader->nPMTs || theEvent.nPMTs > fHeader->nPMTs - theEvent.firstPMT)
+        {
+            std::cout << "ERROR: PMT table of event " << i << " is outside the file" << std::endl;
+            return -1;
+        }
+
+        AllEventFirstPhotonTimes_ns[i] = (theEvent.firstPhotonTime + theEvent.parentTime - fPreEventWindow);
+        unsigned long long Length = (unsigned long long)theEvent.lastPhotonTime
+            - (unsigned long long)theEvent.firstPhotonTime + fPreEventWindow + fPostEventWindow;
+        if (Length > (unsigned long long)PostTriggerWindow)
+            Length = (unsigned long long)PostTriggerWindow;
+
+        const PMTEntry* hit = fPMTs + theEvent.firstPMT;
+        const PMTEntry* lastHit = hit + theEvent.nPMTs;
+        for (int j = 0; j < (int)fHeader->nChannels; j++)
+        {
+            const PMTEntry* thePhotons = nullptr;
+            if (hit != lastHit && hit->pmt == j)
+            {
+                if (hit->firstPhoton > fHeader->nPhotons || hit->nPhotons > fHeader->nPhotons - hit->firstPhoton)
+                {
+                    std::cout << "ERROR: Photons of event " << i << " are outside the file" << std::endl;
+                    return -1;
+                }
+                thePhotons = hit++;
+            }
+            int darkCountRate = PMT::getParamPointer()->getConfig("DarkCount", j);
+            int DarkCounts = determineDarkCounts(Length, darkCountRate);
+            if (thePhotons || DarkCounts != 0)
+            {
+                PMTInfo info;
+                info.PMTnumber = j;
+                info.photons = thePhotons;
+                info.NumberOfDarkCounts = DarkCounts;
+                fEventPMTs[i].push_back(info);
+                fEventNPhotons[i] += (thePhotons ? thePhotons->nPhotons : 0);
+                isAvailable[j] = true;
+            }
+        }
+        if (hit != lastHit)
+        {
+            std::cout << "ERROR: PMT table of event " << i << " is not in increasing PMT order" << std::endl;
+            return -1;
+        }
+
+        double timeSpan = theEvent.lastPhotonTime - theEvent.firstPhotonTime;
+        addAvailableEvent(i, fEventNPhotons[i], theEvent.nPMTs, timeSpan,
+            fEventPMTs[i].empty() || timeSpan >= PhotonTimeLimit);
+    }
+    for (int j = 0; j < (int)isAvailable.size(); j++)
+    {
+        if (isAvailable[j])
+            AvailablePMTs.push_back(j);
+    }
+    SortData();
+    makeEvtListFromSelection();
+    return 0;
+}
+
+int FlatPhotonInput::makePMTDataReady(const unsigned long long& Evt,
+    unsigned long long& NPhotons,
+    unsigned long long& TMin,
+    unsigned long long& TMax,
+    unsigned long long& NVertices,
+    std::vector<int>& PmtsInEvt)
+{
+    /**
+     * Method sets number of photons, first and last photon time for the event.
+     * The pages of the photons of the event are read ahead, as getPMTData()
+     * is called for them next.
+     * Returns -1 if error, 0 if ok.
+     */
+    const EventEntry& theEvent = fEvents[Evt];
+    NPhotons = fEventNPhotons[Evt];
+    TMin = (unsigned long long)theEvent.firstPhotonTime - fPreEventWindow;
+    TMax = (unsigned long long)theEvent.lastPhotonTime + fPostEventWindow;
+    TMax -= TMin;
+    NVertices = theEvent.nVertices;
+    PmtsInEvt.resize(fEventPMTs[Evt].size());
+    for (int i = 0; i < fEventPMTs[Evt].size(); i++)
+    {
+        PmtsInEvt[i] = fEventPMTs[Evt][i].PMTnumber;
+    }
+
+    if (theEvent.nPMTs > 0)
+    {
+        const PMTEntry& theFirst = fPMTs[theEvent.firstPMT];
+        const PMTEntry& theLast = fPMTs[theEvent.firstPMT + theEvent.nPMTs - 1];
+        size_t first = theFirst.firstPhoton;
+        size_t n = theLast.firstPhoton + theLast.nPhotons - first;
+        adviseWillNeed(fTime + first, n * sizeof(double));
+        adviseWillNeed(fWavelength + first, n * sizeof(double));
+        adviseWillNeed(fInteractionID + first, n * sizeof(std::int32_t));
+        adviseWillNeed(fVertexNumber + first, n * sizeof(std::int32_t));
+        adviseWillNeed(fPulseID + first, n * sizeof(std::int32_t));
+    }
+    return 0;
+}
+
+bool FlatPhotonInput::getPMTData(const unsigned long long evt)
+{
+    /**
+     * Retrieve the PMT data for the given event. The EventID is the index of
+     * the event in the file, as for RootInputMDC2.
+     */
+    const EventEntry& theEvent = fEvents[evt];
+    double EventFirstPhotonTimeRelativeToParent_ns = (theEvent.firstPhotonTime - theEvent.parentTime - fPreEventWindow);
+    std::vector<PMTData>().swap(PmtData);
+    PmtData.reserve(fEventNPhotons[evt]);
+
+    for (const PMTInfo& info : fEventPMTs[evt])
+    {
+        if (!info.photons)
+            continue;
+        for (size_t i = info.photons->firstPhoton; i < info.photons->firstPhoton + info.photons->nPhotons; i++)
+        {
+            if ((fTime[i] - EventFirstPhotonTimeRelativeToParent_ns) > PostTriggerWindow)
+                continue;
+            PMTData newPmtData;
+            newPmtData.id = info.PMTnumber;
+            newPmtData.time = fTime[i] - EventFirstPhotonTimeRelativeToParent_ns;
+            newPmtData.wavelength = fWavelength[i];
+            newPmtData.EventID = (int)evt;
+            newPmtData.RunNumber = theEvent.runNumber;
+            newPmtData.InteractionIdentifier = fInteractionID[i];
+            newPmtData.VertexNumber = fVertexNumber[i];
+            PmtData.push_back(newPmtData);
+        }
+    }
+    return true;
+}
+
+bool FlatPhotonInput::getPMTData(const unsigned long long evt,
+    int idx,
+    std::shared_ptr<PMT> thePMT,
+    unsigned long eventLength,
+    unsigned long long timeShift,
+    unsigned long long TimeShiftInc,
+    unsigned long long k)
+{
+    /**
+     * Retrieve the PMT data for a given Event and PMT, straight from the
+     * mapped columns.
+     */
+    const EventEntry& theEvent = fEvents[evt];
+    double EventFirstPhotonTimeRelativeToReferenceTime_ns = (theEvent.firstPhotonTime - fPreEventWindow - theEvent.referencePhotonTime);
+    const PMTInfo& info = fEventPMTs[evt][idx];
+    thePMT->setPMTNumber(info.PMTnumber);
+    thePMT->resetPMTVectors();
+
+    size_t first = (info.photons ? info.photons->firstPhoton : 0);
+    size_t last = (info.photons ? first + info.photons->nPhotons : 0);
+    for (size_t i = first; i < last; i++)
+    {
+        double photonTime = fTime[i] - EventFirstPhotonTimeRelativeToReferenceTime_ns;
+        if (photonTime > PostTriggerWindow)
+            continue;
+        if (photonTime < 0)
+            photonTime = 0;
+        std::shared_ptr<PMT::TimesAndPheResp> thePhoton = std::make_shared<PMT::TimesAndPheResp>();
+        thePhoton->wavelength = fWavelength[i];
+        thePhoton->idx = (unsigned long long)photonTime + timeShift + TimeShiftInc * k;
+        thePhoton->cathodeTime = (unsigned long long)photonTime + timeShift + TimeShiftInc * k;
+        thePhoton->isDER = false;
+        thePhoton->BaccEvtNum = (int)evt;
+        thePhoton->interactionID = fInteractionID[i];
+        thePhoton->vertexNum = fVertexNumber[i];
+        thePhoton->pulseID = fPulseID[i];
+        thePMT->assignPhotonToList(thePhoton, eventLength);
+    }
+    thePMT->generateDarkCounts(evt, info.NumberOfDarkCounts, eventLength);
+    return true;
+}
+
+std::string FlatPhotonInput::getUserName()
+{
+    /**
+     * Get the username of the BACCARAT files the flat file was written from.
+     */
+    return std::string(fMapped + fHeader->userNameOffset, fHeader->userNameLength);
+}
+
+double FlatPhotonInput::getEventFirstPhotonTime(unsigned long long evt)
+{
+    /**
+     * Returns the EventFirstPhotonTime_ns of the specified event.
+     */
+    return AllEventFirstPhotonTimes_ns[evt];
+}
+
+const FlatPhotonInput::EventEntry& FlatPhotonInput::getEventEntry(const unsigned long long& evt) const
+{
+    /**
+     * Returns the directory entry of the specified event, which holds what
+     * the file keeps of its BACCARAT event.
+     */
+    return fEvents[evt];
+}
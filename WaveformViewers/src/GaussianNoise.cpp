@@ -0,0 +1,207 @@
+//
+//  GaussianNoise.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "GaussianNoise.hpp"
+
+GaussianNoise::GaussianNoise()
+    : fSigma(1.0)
+    , fSequencePos(0)
+    , fSequenceDone(0)
+    , fSequenceCarry(0)
+{
+    /**
+     * Constructor for GaussianNoise.
+     */
+}
+
+GaussianNoise::GaussianNoise(const double& sigma)
+    : fSigma(sigma)
+    , fSequencePos(0)
+    , fSequenceDone(0)
+    , fSequenceCarry(0)
+{
+    /**
+     * Constructor for GaussianNoise with standard deviation sigma.
+     */
+}
+
+GaussianNoise::~GaussianNoise()
+{
+    /**
+     * Destructor for GaussianNoise.
+     */
+}
+
+void GaussianNoise::setSigma(const double& sigma)
+{
+    fSigma = sigma;
+    if (!fBank.empty())
+        setBankSize(fBank.size());
+}
+
+double GaussianNoise::getSigma() const
+{
+    return fSigma;
+}
+
+void GaussianNoise::setBankSize(const size_t& bankSize)
+{
+    /**
+     * Pre-generate bankSize noise samples to be reused by fill().
+     * A bankSize of 0 disables the bank so that every sample is fresh.
+     */
+    fBank.resize(bankSize);
+    fBank.shrink_to_fit();
+    if (bankSize > 0)
+        generate(fBank.data(), bankSize);
+}
+
+size_t GaussianNoise::getBankSize() const
+{
+    return fBank.size();
+}
+
+void GaussianNoise::fill(std::vector<double>& noise, const size_t& n)
+{
+    /**
+     * Fill noise with n samples. The vector is resized, not reallocated,
+     * so passing the same vector for every pulse avoids allocations.
+     */
+    noise.resize(n);
+    if (n == 0)
+        return;
+
+    if (fBank.empty())
+    {
+        generate(noise.data(), n);
+        return;
+    }
+
+    const size_t bankSize = fBank.size();
+    size_t pos = gRandom->Integer(bankSize);
+    size_t done = 0;
+    while (done < n)
+    {
+        size_t len = std::min(n - done, bankSize - pos);
+        std::copy(fBank.begin() + pos, fBank.begin() + pos + len, noise.begin() + done);
+        done += len;
+        pos = 0;
+    }
+}
+
+void GaussianNoise::startSequence(const size_t& n)
+{
+    /**
+     * Start a sequence of n samples to be taken with fillNext().
+     *
+     * fill() draws all first uniforms of the Box-Muller pairs followed by
+     * all second ones. To produce the same normals piece by piece, a copy
+     * of gRandom supplies the first uniforms while gRandom itself skips
+     * ahead to the second ones, so that it ends in the same state.
+     */
+    fSequenceDone = 0;
+    fFirstUniforms.reset();
+    if (n == 0)
+        return;
+
+    if (!fBank.empty())
+    {
+        fSequencePos = gRandom->Integer(fBank.size());
+        return;
+    }
+
+    fFirstUniforms.reset(static_cast<TRandom*>(gRandom->Clone()));
+    size_t skip = (n + 1) / 2;
+    fUniforms.resize(std::min(skip, (size_t)65536));
+    while (skip > 0)
+    {
+        size_t len = std::min(skip, fUniforms.size());
+        gRandom->RndmArray(len, fUniforms.data());
+        skip -= len;
+    }
+}
+
+void GaussianNoise::fillNext(std::vector<double>& noise, const size_t& n)
+{
+    /**
+     * Fill noise with the next n samples of the sequence started by
+     * startSequence().
+     */
+    noise.resize(n);
+    if (n == 0)
+        return;
+
+    if (!fBank.empty())
+    {
+        const size_t bankSize = fBank.size();
+        size_t done = 0;
+        while (done < n)
+        {
+            size_t len = std::min(n - done, bankSize - fSequencePos);
+            std::copy(fBank.begin() + fSequencePos, fBank.begin() + fSequencePos + len, noise.begin() + done);
+            done += len;
+            fSequencePos = (fSequencePos + len) % bankSize;
+        }
+        fSequenceDone += n;
+        return;
+    }
+
+    size_t k = 0;
+    if (fSequenceDone % 2)
+        noise[k++] = fSequenceCarry;
+
+    const size_t nPairs = (n - k + 1) / 2;
+    fUniforms.resize(nPairs);
+    fSecondUniforms.resize(nPairs);
+    fFirstUniforms->RndmArray(nPairs, fUniforms.data());
+    gRandom->RndmArray(nPairs, fSecondUniforms.data());
+
+    const double twoPi = 2.0 * M_PI;
+    for (size_t i = 0; i < nPairs; ++i)
+    {
+        double r = fSigma * std::sqrt(-2.0 * std::log(fUniforms[i]));
+        double phi = twoPi * fSecondUniforms[i];
+        noise[k++] = r * std::cos(phi);
+        if (k < n)
+            noise[k++] = r * std::sin(phi);
+        else
+            fSequenceCarry = r * std::sin(phi);
+    }
+    fSequenceDone += n;
+}
+
+void GaussianNoise::generate(double* noise, const size_t& n)
+{
+    /**
+     * Box-Muller transform over blocks of uniforms. Each pair of
+     * uniforms (u1, u2) gives two independent normals
+     * r*cos(2*pi*u2) and r*sin(2*pi*u2) with r = sqrt(-2 ln u1).
+     */
+    const size_t nPairs = (n + 1) / 2;
+    fUniforms.resize(2 * nPairs);
+    gRandom->RndmArray(2 * nPairs, fUniforms.data());
+
+    const double twoPi = 2.0 * M_PI;
+    const double* u1 = fUniforms.data();
+    const double* u2 = fUniforms.data() + nPairs;
+
+    // RndmArray() draws from ]0,1], so the logarithm is always finite.
+    const size_t nFull = n / 2;
+    for (size_t i = 0; i < nFull; ++i)
+    {
+        double r = fSigma * std::sqrt(-2.0 * std::log(u1[i]));
+        double phi = twoPi * u2[i];
+        noise[2 * i] = r * std::cos(phi);
+        noise[2 * i + 1] = r * std::sin(phi);
+    }
+
+    if (n % 2)
+        noise[n - 1] = fSigma * std::sqrt(-2.0 * std::log(u1[nFull])) * std::cos(twoPi * u2[nFull]);
+}
@@ -6,9 +6,14 @@
 //  Copyright © 2016 LZOxford. All rights reserved.
 //
 
+#include <limits>
+
+#include "TROOT.h"
+
 #include "Input.hpp"
 
 Input::Input()
+    : fEventPhotonsEvt(std::numeric_limits<unsigned long long>::max())
 {
     /**
      * Constructor for Input.
@@ -43,6 +48,79 @@ Input::~Input()
      */
 }
 
+bool Input::readsEventPhotons() const
+{
+    /**
+     * Whether the input reads its photons by event with readEventPhotons(),
+     * so that they can be prefetched.
+     */
+    return false;
+}
+
+void Input::readEventPhotons(const unsigned long long& evt, PhotonPrefetcher::EventPhotons& thePhotons)
+{
+    /**
+     * Read the photons of the PMTs of evt. Inputs that read their photons by
+     * event override this and readsEventPhotons().
+     */
+}
+
+const PhotonPrefetcher::EventPhotons& Input::getEventPhotons(const unsigned long long& evt)
+{
+    /**
+     * Returns the photons of the PMTs of evt, from the prefetcher if the
+     * photons are prefetched, else read now.
+     */
+    if (fPrefetcher)
+        return fPrefetcher->get(evt);
+    if (fEventPhotonsEvt != evt)
+    {
+        readEventPhotons(evt, fEventPhotons);
+        fEventPhotonsEvt = evt;
+    }
+    return fEventPhotons;
+}
+
+void Input::startPrefetch(const unsigned int& depth)
+{
+    /**
+     * Prefetch the photons of up to depth selected events ahead in a
+     * background thread. Does nothing if depth is 0 or the input does not
+     * read its photons by event.
+     */
+    stopPrefetch();
+    if (depth == 0)
+        return;
+    if (!readsEventPhotons())
+    {
+        std::cout << "NOTICE: This input cannot prefetch photons, reading them on demand" << std::endl;
+        return;
+    }
+
+    ROOT::EnableThreadSafety();
+    fPrefetcher.reset(new PhotonPrefetcher(
+        [this](const unsigned long long& evt, PhotonPrefetcher::EventPhotons& thePhotons) {
+            readEventPhotons(evt, thePhotons);
+        },
+        SelectedEvents, depth));
+}
+
+void Input::stopPrefetch()
+{
+    /**
+     * Stop prefetching and print how often the simulation waited for the
+     * photons of an event.
+     */
+    if (!fPrefetcher)
+        return;
+
+    std::cout << "Photon prefetch: waited for " << fPrefetcher->getNWaits() << " of "
+              << fPrefetcher->getNEvents() << " events, " << fPrefetcher->getWaitTime() << " s in total"
+              << std::endl;
+    fPrefetcher.reset();
+    fEventPhotonsEvt = std::numeric_limits<unsigned long long>::max();
+}
+
 void Input::setFile(const std::vector<std::string> path)
 {
     /**
@@ -77,7 +155,7 @@ int Input::checkEvtList()
      */
     for (int i = 0; i < SelectedEvents.size(); i++)
     {
-        if (!EventIsContained((int)SelectedEvents[i], AvailableEvents))
+        if (!fCatalog.isAvailable(SelectedEvents[i]))
         {
             std::cout << "ERROR: Invalid event selection." << std::endl;
             std::cout << "Exiting..." << std::endl;
@@ -88,28 +166,23 @@ int Input::checkEvtList()
     return 0;
 }
 
-bool Input::EventIsContained(const int ID,
-    const std::vector<unsigned long long>& FindIn)
+void Input::addAvailableEvent(const unsigned long long& evt, const unsigned long long& nPhotons,
+    const unsigned int& nPMTs, const double& timeSpan, const bool& isEmpty)
 {
     /**
-     * Supply an event ID and a vector of event IDs
-     * Return true if the supplied ID is contained in the vector of IDs
-     *
-     * Return false otherwise
+     * Add an event to the available events, and to the empty events if it is
+     * empty, and catalog its photon count, the number of PMTs with photons
+     * and the time span [ns] of its photons.
      */
-
-    if (FindIn.capacity() > 0)
-    {
-        for (int i = 0; i < FindIn.size(); i++)
-        {
-            if (FindIn[i] == ID)
-            {
-                return true;
-            }
-        }
-    }
-
-    return false;
+    if (isEmpty)
+        EmptyEvents.push_back(evt);
+    AvailableEvents.push_back(evt);
+
+    EventCatalog::Event theEvent;
+    theEvent.nPhotons = nPhotons;
+    theEvent.nPMTs = nPMTs;
+    theEvent.timeSpan = timeSpan;
+    fCatalog.addEvent(evt, theEvent, isEmpty);
 }
 
 std::string Input::getRandomSeedFromFileName()
@@ -329,16 +402,16 @@ unsigned long Input::getNNonEmptyEvts()
     /**
      * Method returns the number of non-empty events from selected event list.
      *
-     * Method can only be called after event list is generated.
+     * Method can only be called after event list is generated. An event
+     * selected more than once is counted each time.
      */
-
     unsigned long cnt = 0;
-    for (int i = 0; i < SelectedEvents.size(); i++)
+    for (const unsigned long long& evt : SelectedEvents)
     {
-        if (std::find(EmptyEvents.begin(), EmptyEvents.end(), SelectedEvents[i]) != EmptyEvents.end())
+        if (!fCatalog.isEmpty(evt))
             ++cnt;
     }
-    return (SelectedEvents.size() - cnt);
+    return cnt;
 }
 
 void Input::SelectDetectors()
@@ -558,7 +631,18 @@ void Input::makeEvtListFromSelection()
     else
         SelectedEvents = makeEvtList();
 
-    checkEvtList();
+    //Cut on the catalogued photon count, PMT count and time span. An invalid
+    //selection is left uncut, for the run to stop on.
+    std::string cut = global::get_optional_config("EventCut", "none");
+    if (checkEvtList() == 0 && cut != "none" && !cut.empty())
+    {
+        unsigned long long nSelected = SelectedEvents.size();
+        SelectedEvents = fCatalog.applyCut(cut, SelectedEvents);
+        std::cout << "NOTICE: EventCut \"" << cut << "\" removed " << nSelected - SelectedEvents.size()
+                  << " of " << nSelected << " events" << std::endl;
+    }
+
+    fCatalog.select(SelectedEvents);
 }
 
 void Input::getBaccObj()
@@ -588,3 +672,14 @@ double Input::getEventFirstPhotonTime(unsigned long long evt)
      */
     return 1;
 }
+
+int Input::determineDarkCounts(const unsigned long length, double darkCountRate) {
+    /**
+     * Method to generate Dark counts
+     */
+    //Add dark counts from photocathode
+    unsigned long long seed = std::chrono::system_clock::now().time_since_epoch().count();
+    std::default_random_engine generator((unsigned int)seed);
+    std::poisson_distribution<int> distribution(darkCountRate*length/1e9);
+    return distribution(generator); 
+}
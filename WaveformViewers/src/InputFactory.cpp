@@ -13,6 +13,7 @@
 
 #include "InputFactory.hpp"
 
+#include "FlatPhotonInput.hpp"
 #include "RootInputMDC1.hpp"
 #include "RootInputMDC2.hpp"
 
@@ -44,6 +45,10 @@ Input* InputFactory::getInput(const format::revision inputType)
     {
         return new RootInputMDC1();
     }
+    else if (inputType == format::revision::FLATv1)
+    {
+        return new FlatPhotonInput();
+    }
     else
         return new RootInputMDC2(); //Default to latest version
 }
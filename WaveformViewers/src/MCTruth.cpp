@@ -6,12 +6,18 @@
 //  Copyright © 2016 LZOxford. All rights reserved.
 //
 
+#include <stdexcept>
+
 #include "MCTruth.hpp"
 #include "Output.hpp"
 
 MCTruth::MCTruth()
-    : nPhotonsInPODs(0)
+    : truthSize(0)
+    , podEvent(0)
+    , podRunNumber(-1)
+    , nPhotonsInPODs(0)
     , nDarkCounts(0)
+    , timeOrderValid(false)
 {
     /**
      * Constructor for MCTruth.
@@ -28,19 +34,31 @@ MCTruth::~MCTruth()
 void MCTruth::setMCTruthSize(const unsigned long size)
 {
     /**
-     * Set size of vector containing MCTruthData objects.
+     * Set the number of MCTruthData objects.
      */
-    theMCTruthData.resize(size);
+    truthSize = size;
+    theTruthColumns.ArrivalTime.resize(size);
+    theTruthColumns.wavelength.resize(size);
+    theTruthColumns.PMTNumber.resize(size);
+    theTruthColumns.SimEvt.resize(size);
+    theTruthColumns.pheType.resize(size);
+    theTruthColumns.InteractionIdentifier.resize(size);
+    theTruthColumns.VertexNumber.resize(size);
+    theTruthColumns.PulseID.resize(size);
+    theTruthColumns.HGPODIdx.resize(size);
+    theTruthColumns.LGPODIdx.resize(size);
+    theTruthColumns.flags.resize(size);
     nPhotonsInPODs = 0;
     nDarkCounts = 0;
+    timeOrderValid = false;
 }
 
 unsigned long MCTruth::getTruthSize()
 {
     /**
-     * Get size of vector containing MCTruthData objects.
+     * Get the number of MCTruthData objects.
      */
-    return theMCTruthData.size();
+    return truthSize;
 }
 
 int MCTruth::getNPhotonsInPODs()
@@ -73,24 +91,26 @@ void MCTruth::addDERTruth(const int idx,
     const unsigned short PulseID)
 {
     /**
-     * Method adds new MCTruthData object to theMCTruthData vector. 
+     * Method sets the MCTruthData object at idx.
+     *
+     * Arrival times are ns within the event window and BACCARAT event
+     * numbers are stored in 32 bits.
      */
-    MCTruthData newTruth;
-    newTruth.PMTNumber = PMTNumber;
-    newTruth.pheType = pheType;
-    newTruth.isDER = isDER;
-    newTruth.SimEvt = SimEvtNumber; //Implicit type conversion. Check type!
-    newTruth.ArrivalTime = ArrivalTime;
-    newTruth.wavelength = wavelength;
-    newTruth.InteractionIdentifier = InteractionIdentifier;
-    newTruth.VertexNumber = VertexNumber;
-    newTruth.PulseID = PulseID;
-    newTruth.HGPODIdx = 0; //This is set at POD stage, once a photon has actually made it into the evt.
-    newTruth.LGPODIdx = 0; //This is set at POD stage.
-    newTruth.DEREvt = 0; //This is set at POD stage.
-    newTruth.SimRunNumber = -1; //This is set at POD stage.
-    newTruth.counted = false;
-    theMCTruthData[idx] = (newTruth);
+    if (ArrivalTime > UINT32_MAX)
+        throw std::out_of_range("MCTruth: photon arrival time beyond 2^32 ns");
+
+    theTruthColumns.ArrivalTime[idx] = ArrivalTime;
+    theTruthColumns.wavelength[idx] = wavelength;
+    theTruthColumns.PMTNumber[idx] = PMTNumber;
+    theTruthColumns.SimEvt[idx] = SimEvtNumber; //Implicit type conversion. Check type!
+    theTruthColumns.pheType[idx] = pheType;
+    theTruthColumns.InteractionIdentifier[idx] = InteractionIdentifier;
+    theTruthColumns.VertexNumber[idx] = VertexNumber;
+    theTruthColumns.PulseID[idx] = PulseID;
+    theTruthColumns.HGPODIdx[idx] = 0; //This is set at POD stage, once a photon has actually made it into the evt.
+    theTruthColumns.LGPODIdx[idx] = 0; //This is set at POD stage.
+    theTruthColumns.flags[idx] = (isDER ? kIsDER : 0);
+    timeOrderValid = false;
 }
 
 void MCTruth::addHGPODIdx(const int idx,
@@ -100,17 +120,8 @@ void MCTruth::addHGPODIdx(const int idx,
     /**
     * Method to add HG POD idx to the truth object.
     */
-    theMCTruthData[idx].HGPODIdx = Output::getNPODsEvt();
-    theMCTruthData[idx].DEREvt = DERevt;
-    theMCTruthData[idx].SimRunNumber = SimRunNum;
-
-    if (theMCTruthData[idx].counted == false)
-    {
-        ++nPhotonsInPODs;
-        theMCTruthData[idx].counted = true;
-        if (theMCTruthData[idx].pheType == 5)
-            ++nDarkCounts;
-    }
+    theTruthColumns.HGPODIdx[idx] = Output::getNPODsEvt();
+    addPODIdx(idx, DERevt, SimRunNum);
 }
 
 void MCTruth::addLGPODIdx(const int idx,
@@ -120,25 +131,114 @@ void MCTruth::addLGPODIdx(const int idx,
     /**
     * Method to add LG POD idx to the truth object.
     */
-    theMCTruthData[idx].LGPODIdx = Output::getNPODsEvt();
-    theMCTruthData[idx].DEREvt = DERevt;
-    theMCTruthData[idx].SimRunNumber = SimRunNum;
+    theTruthColumns.LGPODIdx[idx] = Output::getNPODsEvt();
+    addPODIdx(idx, DERevt, SimRunNum);
+}
+
+void MCTruth::addPODIdx(const unsigned long idx, const unsigned long DEREvt, const int SimRunNum)
+{
+    /**
+     * Mark the photon at idx as being in a POD of DER event DEREvt.
+     */
+    podEvent = DEREvt;
+    podRunNumber = SimRunNum;
 
-    if (theMCTruthData[idx].counted == false)
+    if (!(theTruthColumns.flags[idx] & kInPOD))
     {
         ++nPhotonsInPODs;
-        theMCTruthData[idx].counted = true;
-        if (theMCTruthData[idx].pheType == 5)
+        theTruthColumns.flags[idx] |= kInPOD;
+        if (theTruthColumns.pheType[idx] == 5)
             ++nDarkCounts;
     }
 }
 
-MCTruth::MCTruthData* MCTruth::getMCTruthDataObject(const int idx)
+MCTruth::MCTruthData MCTruth::getMCTruthData(const unsigned long idx) const
+{
+    /**
+     * Build the MCTruthData object of the photon at idx from the columns.
+     */
+    const bool inPOD = isInPOD(idx);
+    MCTruthData theData;
+    theData.ArrivalTime = theTruthColumns.ArrivalTime[idx];
+    theData.wavelength = theTruthColumns.wavelength[idx];
+    theData.PMTNumber = theTruthColumns.PMTNumber[idx];
+    theData.SimEvt = theTruthColumns.SimEvt[idx];
+    theData.SimRunNumber = (inPOD ? podRunNumber : -1);
+    theData.DEREvt = (inPOD ? podEvent : 0);
+    theData.pheType = theTruthColumns.pheType[idx];
+    theData.isDER = (theTruthColumns.flags[idx] & kIsDER);
+    theData.InteractionIdentifier = theTruthColumns.InteractionIdentifier[idx];
+    theData.VertexNumber = theTruthColumns.VertexNumber[idx];
+    theData.PulseID = theTruthColumns.PulseID[idx];
+    theData.HGPODIdx = theTruthColumns.HGPODIdx[idx];
+    theData.LGPODIdx = theTruthColumns.LGPODIdx[idx];
+    theData.counted = inPOD;
+    return theData;
+}
+
+bool MCTruth::isInPOD(const unsigned long idx) const
 {
     /**
-     * Get pointer to MCTruthData object at idx of theMCTruthData vector.
+     * Whether the photon at idx made it into a POD.
      */
-    return &theMCTruthData[idx];
+    return theTruthColumns.flags[idx] & kInPOD;
+}
+
+void MCTruth::findTruthInWindow(const unsigned long long startTime,
+    const unsigned long long endTime,
+    unsigned long& first,
+    unsigned long& last)
+{
+    /**
+     * Find the photons (non-zero pheType) arriving between startTime and
+     * endTime inclusive, as the range [first, last) of the photons sorted by
+     * arrival time. getTimeOrderedIdx() gives their MCTruthData indices.
+     *
+     * The photons are kept sorted by arrival time, so finding those of a POD
+     * takes a binary search rather than a pass over all MCTruthData objects.
+     */
+    if (!timeOrderValid)
+        buildTimeOrder();
+
+    auto begin = timeOrderTimes.begin();
+    auto firstTime = begin;
+    auto lastTime = begin;
+    if (startTime <= UINT32_MAX)
+    {
+        firstTime = std::lower_bound(begin, timeOrderTimes.end(), (uint32_t)startTime);
+        lastTime = (endTime < UINT32_MAX ? std::upper_bound(firstTime, timeOrderTimes.end(), (uint32_t)endTime)
+                                         : timeOrderTimes.end());
+    }
+    first = firstTime - begin;
+    last = lastTime - begin;
+}
+
+unsigned long MCTruth::getTimeOrderedIdx(const unsigned long i) const
+{
+    /**
+     * Get the MCTruthData index of the photon at position i when the photons
+     * are sorted by arrival time.
+     */
+    return timeOrder[i];
+}
+
+void MCTruth::buildTimeOrder()
+{
+    /**
+     * Sort the photon entries by arrival time.
+     */
+    const std::vector<uint32_t>& times = theTruthColumns.ArrivalTime;
+    timeOrder.clear();
+    for (unsigned long i = 0; i < truthSize; ++i)
+        if (theTruthColumns.pheType[i])
+            timeOrder.push_back(i);
+    std::stable_sort(timeOrder.begin(), timeOrder.end(), [&times](const unsigned long a, const unsigned long b) {
+        return times[a] < times[b];
+    });
+    timeOrderTimes.resize(timeOrder.size());
+    for (size_t i = 0; i < timeOrder.size(); ++i)
+        timeOrderTimes[i] = times[timeOrder[i]];
+    timeOrderValid = true;
 }
 
 void MCTruth::setPODTruthSize(const unsigned long size)
@@ -163,19 +263,21 @@ void MCTruth::addPODTruth(const unsigned long idx,
     MCTruthData* Ptr)
 {
     /**
-     * Method to add new PODTruth object without MCTruthData pointer at
-     * the end of thePODTruth vector.
+     * Method to add new PODTruth object without photons at the end of
+     * thePODTruth vector.
      *
      * Channel and event number are set, but pointer to the TruthData
      * object is ignored.
      * This method is intended to be called for every POD. The
-     * setPODTruthAt method should be subsequently used to fill
-     * the MCTruthData pointer vector.
+     * setPODTruthAt method should be subsequently used to set
+     * the range of photons in the POD.
      *
      * The method is intended to be used to initialize a PODTruth object
      * for every POD.
      */
     PODTruth newPODTruth;
+    newPODTruth.first = 0;
+    newPODTruth.last = 0;
     newPODTruth.channel = channel;
     newPODTruth.Event = Event;
     thePODTruth.push_back(newPODTruth);
@@ -190,11 +292,11 @@ void MCTruth::getPODTruthAt(const int idx)
     std::cout << "The POD Truth at idx " << idx << std::endl;
     std::cout << "Channel " << thePODTruth.at(idx).channel << std::endl;
     std::cout << "Event " << thePODTruth.at(idx).Event << std::endl;
-    std::cout << "Pointers to truth objects:" << std::endl;
-    std::cout << "Size " << thePODTruth.at(idx).PtrToMCTruth.size() << std::endl;
-    for (int i = 0; i < thePODTruth.at(idx).PtrToMCTruth.size(); i++)
+    std::cout << "Indices of truth objects:" << std::endl;
+    std::cout << "Size " << thePODTruth.at(idx).last - thePODTruth.at(idx).first << std::endl;
+    for (unsigned long i = thePODTruth.at(idx).first; i < thePODTruth.at(idx).last; i++)
     {
-        std::cout << "i " << i << " pointer to " << thePODTruth.at(i).PtrToMCTruth.at(i) << std::endl;
+        std::cout << "i " << i << " index " << timeOrder.at(i) << std::endl;
     }
     std::cout << "Done." << std::endl;
 }
@@ -202,19 +304,19 @@ void MCTruth::getPODTruthAt(const int idx)
 void MCTruth::setPODTruthAt(const unsigned long idx,
     const unsigned long channel,
     const unsigned long Event,
-    MCTruthData* Ptr)
+    const unsigned long first,
+    const unsigned long last)
 {
     /**
      * Method to set channel and event numbers of PODTruth object
-     * at index (idx) of the PODTruth vector and add a pointer
-     * to an MCTruthData object contained within the POD to a vector.
-     *
-     * This method is intended to be called to fill a PODTruth object with
-     * pointers to MCTruthData Objects.
+     * at index (idx) of the PODTruth vector and the range [first, last)
+     * of the time ordered photons contained within the POD, as found by
+     * findTruthInWindow().
      */
     thePODTruth[idx].channel = channel;
     thePODTruth[idx].Event = Event;
-    thePODTruth[idx].PtrToMCTruth.push_back(Ptr);
+    thePODTruth[idx].first = first;
+    thePODTruth[idx].last = last;
 }
 
 MCTruth::PODTruth* MCTruth::getPODTruthObject(const int idx)
@@ -44,6 +44,29 @@ void Output::doInitInputVariables(Input* input)
      */
 }
 
+void Output::doWriteData(const PODArena& thePODs)
+{
+    /**
+     * Write all PODs of thePODs in order. Formats without their own version
+     * of this method get each POD passed to doWriteData(POD&, const int&).
+     */
+    POD thePOD;
+    for (size_t i = 0; i < thePODs.size(); ++i)
+    {
+        const PODArena::Descriptor& theDescriptor = thePODs.at(i);
+        const short* samples = thePODs.getSamples(theDescriptor);
+        thePOD.assign(samples, samples + theDescriptor.length);
+        thePOD.setEvent(theDescriptor.event);
+        thePOD.setLUXSimRunNumber(theDescriptor.luxSimRunNumber);
+        thePOD.setChannel(theDescriptor.channel);
+        thePOD.setDataCollector(theDescriptor.dataCollector);
+        thePOD.setPODStartTimeStamp(theDescriptor.start);
+        thePOD.setPODLength(theDescriptor.length);
+        thePOD.setHitID(theDescriptor.hitID);
+        doWriteData(thePOD, theDescriptor.dataCollector);
+    }
+}
+
 void Output::doStoreSubsetLG(const Pulse& thePulse)
 {
     /**
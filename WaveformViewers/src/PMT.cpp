@@ -17,6 +17,9 @@ std::shared_ptr<DBInterface<double>> PMT::myCSV{nullptr};
 PMT::PMT(const der::DeviceModel& model)
     : iPMTNumber(0)
     , fInitialised(false)
+    , fSlicedNhalf(0)
+    , fSlicedStartPoint(0)
+    , fSlicedEndPoint(0)
 {
     this->setName("PMT");
     sModel = model;
@@ -71,6 +74,9 @@ PMT::PMT(const der::DeviceModel& model)
 
 PMT::PMT(unsigned int RealLZPMTNumber)
     : iPMTNumber(RealLZPMTNumber)
+    , fSlicedNhalf(0)
+    , fSlicedStartPoint(0)
+    , fSlicedEndPoint(0)
 {
     /**
      * Constructor for PMT setting PMT number.
@@ -166,6 +172,69 @@ void PMT::doResponse(Pulse& thePulse)
         doAnalyticPMTResponse(thePulse);
 }
 
+void PMT::doResponse(SegmentedPulse& thePulse)
+{
+    if (thePulse.getChannel() != iPMTNumber || !fInitialised)
+    {
+        this->setPMTNumber(iPMTNumber);
+        fInitialised = true;
+    }
+    if (sModel == der::DeviceModel::kSampled)
+        std::cout << "NOTICE : no possible sampled reponse" << std::endl;
+    else
+        doAnalyticPMTResponse(thePulse);
+}
+
+void PMT::doResponse(SlicedPulse& thePulse)
+{
+    /**
+     * Draw the hit amplitudes as for a dense pulse and register their photon
+     * intervals. The samples are added slice by slice with fillSlice().
+     */
+    if (thePulse.getChannel() != iPMTNumber || !fInitialised)
+    {
+        this->setPMTNumber(iPMTNumber);
+        fInitialised = true;
+    }
+    fSlicedHits.clear();
+    if (sModel == der::DeviceModel::kSampled)
+        std::cout << "NOTICE : no possible sampled reponse" << std::endl;
+    else
+        drawHits(fSlicedHits, fSlicedNhalf, fSlicedStartPoint, fSlicedEndPoint);
+    repeatResponse(thePulse);
+}
+
+void PMT::repeatResponse(SlicedPulse& thePulse)
+{
+    /**
+     * Register the photon intervals of the hits of the last
+     * doResponse(SlicedPulse&) on another pulse, e.g. for the other gain.
+     */
+    for (auto& hit : fSlicedHits)
+        thePulse.addPhotonInterval(fSlicedStartPoint + hit.first - fSlicedNhalf,
+            fSlicedEndPoint - 1 + hit.first - fSlicedNhalf);
+    thePulse.sortPhotonIntervals();
+}
+
+void PMT::fillSlice(SlicedPulse& thePulse, const unsigned long& first, const unsigned long& last)
+{
+    /**
+     * Add the response of every hit to the samples [first, last), which must
+     * be in the window of thePulse. Hits are added in the same order as for
+     * a dense pulse, so the sums are identical.
+     */
+    for (auto& hit : fSlicedHits)
+    {
+        unsigned long hitStart = fSlicedStartPoint + hit.first - fSlicedNhalf;
+        unsigned long hitEnd = fSlicedEndPoint + hit.first - fSlicedNhalf;
+        unsigned long lo = std::max(hitStart, first);
+        unsigned long hi = std::min(hitEnd, last);
+        if (lo < hi)
+            PulseMath::addScaled(&thePulse.sample(lo),
+                &fPmtPulseSamples[fSlicedStartPoint + (lo - hitStart)], hit.second, hi - lo);
+    }
+}
+
 void PMT::doResponse(Pulse& theLGPulse, Pulse& theHGPulse)
 {
     if (theLGPulse.getChannel() != iPMTNumber || !fInitialised)
@@ -263,11 +332,8 @@ void PMT::doAnalyticPMTResponse(Pulse& thePulse)
 
         //Scale PMT pulse, then assign to main pulse
 
-        for (unsigned long j = startPoint; j < endPoint; j++)
-        {
-            thePulse[j + IdxList[i]->idx - Nhalf] +=
-	      GausRespAmp * fPmtPulseSamples[j];
-        }
+        PulseMath::addScaled(&thePulse[startPoint + IdxList[i]->idx - Nhalf],
+            &fPmtPulseSamples[startPoint], GausRespAmp, endPoint - startPoint);
     }
     timer.Stop();
     cumulativeRealTimes[3] += timer.RealTime();
@@ -285,11 +351,8 @@ void PMT::doAnalyticPMTResponse(Pulse& thePulse)
 	thePulse.addPhotonInterval(startSample, endSample);
 
         //Scale PMT pulse, then assign to main pulse
-        for (unsigned long j = startPoint; j < endPoint; j++)
-        {
-	  thePulse[j + FirstDyn[i]->idx - Nhalf] += 
-	    GausRespAmp * fPmtPulseSamples[j];
-        }
+        PulseMath::addScaled(&thePulse[startPoint + FirstDyn[i]->idx - Nhalf],
+            &fPmtPulseSamples[startPoint], GausRespAmp, endPoint - startPoint);
     }
     cumulativeRealTimes[4] += timer.RealTime();
     cumulativeCPUTimes[4] += timer.CpuTime();
@@ -307,11 +370,8 @@ void PMT::doAnalyticPMTResponse(Pulse& thePulse)
 	thePulse.addPhotonInterval(startSample, endSample);
 
         //Scale PMT pulse, then assign to main pulse
-        for (unsigned long j = startPoint; j < endPoint; j++)
-        {
-            thePulse[j + SecondDyn[i]->idx - Nhalf]  +=
-	      GausRespAmp * fPmtPulseSamples[j];
-        }
+        PulseMath::addScaled(&thePulse[startPoint + SecondDyn[i]->idx - Nhalf],
+            &fPmtPulseSamples[startPoint], GausRespAmp, endPoint - startPoint);
     }
     timer.Stop();
     cumulativeRealTimes[5] += timer.RealTime();
@@ -328,11 +388,8 @@ void PMT::doAnalyticPMTResponse(Pulse& thePulse)
 	thePulse.addPhotonInterval(startSample, endSample);
 
         //Scale PMT pulse, then assign to main pulse
-        for (unsigned long j = startPoint; j < endPoint; j++)
-        {
-            thePulse[j + DarkList[i]->idx - Nhalf] += 
-	      GausRespAmp * fPmtPulseSamples[j];
-        }
+        PulseMath::addScaled(&thePulse[startPoint + DarkList[i]->idx - Nhalf],
+            &fPmtPulseSamples[startPoint], GausRespAmp, endPoint - startPoint);
     }
     timer.Stop();
     cumulativeRealTimes[6] += timer.RealTime();
@@ -354,11 +411,8 @@ void PMT::doAnalyticPMTResponse(Pulse& thePulse)
 	thePulse.addPhotonInterval(startSample, endSample);
 
         //Scale PMT pulse, then assign to main pulse
-        for (unsigned long j = startPoint; j < endPoint; j++)
-        {
-            thePulse[j + AftPlsList[i]->idx - Nhalf] +=
-	      GausRespAmp * fPmtPulseSamples[j];
-        }
+        PulseMath::addScaled(&thePulse[startPoint + AftPlsList[i]->idx - Nhalf],
+            &fPmtPulseSamples[startPoint], GausRespAmp, endPoint - startPoint);
     }
     thePulse.sortPhotonIntervals();
     timer.Stop();
@@ -367,6 +421,93 @@ void PMT::doAnalyticPMTResponse(Pulse& thePulse)
     //resetPMTVectors();
 }
 
+void PMT::drawHits(std::vector<std::pair<unsigned long long, double> >& hits, unsigned long& Nhalf,
+    unsigned long& startPoint, unsigned long& endPoint)
+{
+    /**
+     * Draw the amplitude of every hit, in the order of the dense response,
+     * as (sample index, amplitude) pairs. The response of a hit at index idx
+     * is fPmtPulseSamples[startPoint, endPoint) added from sample
+     * startPoint + idx - Nhalf on.
+     */
+
+    Nhalf = fPmtPulseSamples.size() * 0.5;
+
+    startPoint = Nhalf+1;
+    endPoint = Nhalf+1;
+    for(unsigned long i = 0; i<fPmtPulseSamples.size(); ++i){
+      if(fPmtPulseSamples[i] != 0){
+	startPoint = i;
+	break;
+      }
+    }
+    for(unsigned long i = startPoint; i<fPmtPulseSamples.size(); ++i){
+      if(std::abs(fPmtPulseSamples[i])<1e-8){
+	endPoint = i;
+	break;
+      }
+    }
+
+    hits.clear();
+    hits.reserve(IdxList.size() + FirstDyn.size() + SecondDyn.size()
+		 + DarkList.size() + AftPlsList.size());
+
+    for (int i = 0; i < IdxList.size(); i++)
+    {
+        double initAmp = getGaussSpread(1, fSpheRes);
+        double DoublePheAmp = 0.0;
+        if (IdxList[i]->is2Phe)
+            DoublePheAmp = getGaussSpread(1, fSpheRes);
+        hits.push_back(std::make_pair(IdxList[i]->idx, (initAmp + DoublePheAmp) * fNominalScaleGain));
+    }
+    for (int i = 0; i < FirstDyn.size(); i++)
+        hits.push_back(std::make_pair(FirstDyn[i]->idx,
+            getGaussSpread(1, fFirstDynHitRes) * fFirstDynodeScaleGain));
+    for (int i = 0; i < SecondDyn.size(); i++)
+        hits.push_back(std::make_pair(SecondDyn[i]->idx,
+            getGaussSpread(1, fSecondDynCollRes) * fSecondDynodeScaleGain));
+    for (int i = 0; i < DarkList.size(); i++)
+        hits.push_back(std::make_pair(DarkList[i]->idx,
+            getGaussSpread(1, fSpheRes) * fNominalScaleGain));
+    for (int i = 0; i < AftPlsList.size(); i++)
+    {
+        double initAmp = 0.0;
+        for (int j = 0; j < AftPlsList[i]->AftPlsNPE; j++)
+            initAmp += getGaussSpread(1, fSpheRes);
+        hits.push_back(std::make_pair(AftPlsList[i]->idx, initAmp * fNominalScaleGain));
+    }
+}
+
+void PMT::doAnalyticPMTResponse(SegmentedPulse& thePulse)
+{
+    /**
+     * Segmented version of the analytic PMT response. The amplitudes are
+     * drawn in the same order as for a dense pulse, the segments are built
+     * from the hit intervals and each response is added to its segment.
+     */
+
+    unsigned long Nhalf, startPoint, endPoint;
+    std::vector<std::pair<unsigned long long, double> > hits;
+    drawHits(hits, Nhalf, startPoint, endPoint);
+
+    for (auto& hit : hits)
+        thePulse.addInterval(startPoint + hit.first - Nhalf, endPoint - 1 + hit.first - Nhalf);
+    thePulse.buildSegments();
+
+    for (auto& hit : hits)
+    {
+        unsigned long startSample = startPoint + hit.first - Nhalf;
+        size_t s = thePulse.findSegment(startSample);
+        if (s == thePulse.getNSegments())
+            continue; //hit outside the event window
+        SegmentedPulse::Segment& segment = thePulse.getSegment(s);
+        unsigned long stop = std::min(endPoint, (unsigned long)(segment.end() + Nhalf - hit.first));
+        if (stop > startPoint)
+            PulseMath::addScaled(segment.samples.data() + (startSample - segment.start),
+                &fPmtPulseSamples[startPoint], hit.second, stop - startPoint);
+    }
+}
+
 void PMT::doSampledPMTResponse(Pulse& thePulse,
     Pulse& thePulseHG)
 {
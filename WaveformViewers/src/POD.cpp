@@ -56,36 +56,49 @@ void POD::setMCTruth(std::shared_ptr<MCTruth> theTruth)
      * object, which is in turn contained within a vector.
      */
 
+    unsigned long first = 0;
+    unsigned long last = 0;
     if (theTruth != nullptr)
-    {
-        theTruth->addPODTruth(0, fChannel, fEvent, 0);
-        const unsigned long long idx{ theTruth->getPODTruthSize() - 1 };
-        const bool isHighGain{ fChannel < 1000 };
-        set_mctruth(theTruth, idx, isHighGain);
-    }
+        addMCTruth(theTruth, fChannel, fEvent, fLuxSimRunNumber, fStartTime, this->size(), fSamplingRate, first, last);
 }
 
-void POD::set_mctruth(std::shared_ptr<MCTruth> theTruth, const unsigned long long& idx, bool highGain) const
+unsigned long long POD::addMCTruth(std::shared_ptr<MCTruth> theTruth, const int& channel,
+    const unsigned long long& event, const int& luxSimRunNumber, const unsigned long long& startTime,
+    const size_t& nSamples, const int& samplingRate, unsigned long& first, unsigned long& last)
 {
-    const unsigned long startTime{ fStartTime * fSamplingRate };
-    const unsigned long endTime{ startTime + (this->size() * fSamplingRate) };
-    for (auto i = 0; i < theTruth->getTruthSize(); i++)
+    /**
+     * Add the PODTruth of a POD with the given properties to theTruth, which
+     * must not be null, and return its index. The photons in the POD are
+     * [first, last) of the time ordered photons of theTruth. This is what
+     * setMCTruth() does and is also used for PODs kept in a PODArena.
+     */
+    theTruth->addPODTruth(0, channel, event, 0);
+    const unsigned long long idx{ theTruth->getPODTruthSize() - 1 };
+    const bool isHighGain{ channel < 1000 };
+    set_mctruth(theTruth, idx, isHighGain, channel, event, luxSimRunNumber, startTime, nSamples, samplingRate,
+        first, last);
+    return idx;
+}
+
+void POD::set_mctruth(std::shared_ptr<MCTruth> theTruth, const unsigned long long& idx, bool highGain,
+    const int& channel, const unsigned long long& event, const int& luxSimRunNumber,
+    const unsigned long long& podStartTime, const size_t& nSamples, const int& samplingRate,
+    unsigned long& first, unsigned long& last)
+{
+    const unsigned long startTime{ podStartTime * samplingRate };
+    const unsigned long endTime{ startTime + (nSamples * samplingRate) };
+    theTruth->findTruthInWindow(startTime, endTime, first, last);
+    theTruth->setPODTruthAt(idx, channel, event, first, last);
+    for (unsigned long k = first; k < last; ++k)
     {
-        const unsigned long long time{ theTruth->getMCTruthDataObject(i)->ArrivalTime };
-        if (theTruth->getMCTruthDataObject(i)->pheType)
+        const unsigned long i{ theTruth->getTimeOrderedIdx(k) };
+        if (highGain)
+        {
+            theTruth->addHGPODIdx(i, event, luxSimRunNumber);
+        }
+        else
         {
-            if (time >= startTime && time <= endTime)
-            {
-                theTruth->setPODTruthAt(idx, fChannel, fEvent, theTruth->getMCTruthDataObject(i));
-                if (highGain)
-                {
-                    theTruth->addLGPODIdx(i, fEvent, fLuxSimRunNumber);
-                }
-                else
-                {
-                    theTruth->addLGPODIdx(i, fEvent, fLuxSimRunNumber);
-                }
-            }
+            theTruth->addLGPODIdx(i, event, luxSimRunNumber);
         }
     }
 }
@@ -0,0 +1,100 @@
+//
+//  PODArena.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include "PODArena.hpp"
+#include "Config.hpp"
+#include "POD.hpp"
+
+PODArena::PODArena()
+    : fSamplingRate{ std::stoi(global::config->getConfig("SmplRate")) }
+{
+    /**
+     * Constructor for PODArena.
+     */
+}
+
+PODArena::~PODArena()
+{
+    /**
+     * Destructor for PODArena.
+     */
+}
+
+void PODArena::clear()
+{
+    /**
+     * Remove all PODs, keeping the allocated storage for the next event.
+     */
+    fSamples.clear();
+    fPODs.clear();
+}
+
+PODArena::Descriptor& PODArena::addPOD(const unsigned long long& length)
+{
+    /**
+     * Add a POD of length samples, which are zero, and return its
+     * descriptor for the caller to fill in. The reference and the sample
+     * pointers are invalidated by the next call.
+     */
+    Descriptor thePOD = Descriptor();
+    thePOD.length = length;
+    thePOD.offset = fSamples.size();
+    thePOD.highGain = true;
+    thePOD.truthFirst = 0;
+    thePOD.truthLast = 0;
+    fSamples.resize(fSamples.size() + length);
+    fPODs.push_back(thePOD);
+    return fPODs.back();
+}
+
+size_t PODArena::size() const
+{
+    return fPODs.size();
+}
+
+PODArena::Descriptor& PODArena::at(const size_t& i)
+{
+    return fPODs.at(i);
+}
+
+const PODArena::Descriptor& PODArena::at(const size_t& i) const
+{
+    return fPODs.at(i);
+}
+
+short* PODArena::getSamples(const Descriptor& thePOD)
+{
+    return fSamples.data() + thePOD.offset;
+}
+
+const short* PODArena::getSamples(const Descriptor& thePOD) const
+{
+    return fSamples.data() + thePOD.offset;
+}
+
+int PODArena::getSamplingRate() const
+{
+    return fSamplingRate;
+}
+
+void PODArena::setMCTruth(const size_t& first, std::shared_ptr<MCTruth> theTruth)
+{
+    /**
+     * Associate the PODs from first onwards with theTruth, as
+     * POD::setMCTruth() does for a single POD. Used when the PODs are formed
+     * before the MCTruth is complete.
+     */
+    if (theTruth == nullptr)
+        return;
+
+    for (size_t i = first; i < fPODs.size(); ++i)
+    {
+        Descriptor& thePOD = fPODs[i];
+        POD::addMCTruth(theTruth, thePOD.channel, thePOD.event, thePOD.luxSimRunNumber, thePOD.start,
+            thePOD.length, fSamplingRate, thePOD.truthFirst, thePOD.truthLast);
+    }
+}
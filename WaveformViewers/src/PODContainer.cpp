@@ -2,20 +2,33 @@
 //  PODContainer.cpp
 //
 
+#include <algorithm>
+#include <cmath>
+
 #include "PODContainer.hpp"
 #include "Config.hpp"
 
+#include "TRandom.h"
+
 PODContainer::PODContainer()
     : timesNextCalled(0)
     , elementSamplingRate(1)
-    , podTriggerThreshold(8000)
+    , interPodSampleThreshold(std::stoi(global::config->getConfig("IntrPodTime")))
     , preTriggerSamples(std::stoi(global::config->getConfig("PreTrigger")))
     , postTriggerSamples(std::stoi(global::config->getConfig("PostTrigger")))
-    , interPodSampleThreshold(std::stoi(global::config->getConfig("IntrPodTime")))
+    , podTriggerThreshold(8000)
+    , fArena(nullptr)
+    , fHasBaseline(false)
+    , fBaseline(0)
+    , fBaselineSigma(0)
+    , fStreamFirst(0)
+    , fStreamNext(0)
+    , fStreamExtracted(0)
 {
     /**
    * Constructor for PODContainer.
      */
+    fScan.active = false;
 }
 
 PODContainer::~PODContainer()
@@ -27,7 +40,125 @@ PODContainer::~PODContainer()
     //   delete pod;
 }
 
+namespace
+{
+// Sample access shared by the dense and segmented POD finding. variance is
+// the spread of the returned value, non-zero only for segmented pulse gaps.
+inline double readSample(const Pulse& thePulse, const unsigned long& i, double& variance)
+{
+    variance = 0;
+    return thePulse[i];
+}
+
+inline double readSample(const SegmentedPulse& thePulse, const unsigned long& i, double& variance)
+{
+    return thePulse.sample(i, variance);
+}
+
+// Samples of a pulse without variance that can be scanned as an array.
+inline const double* contiguousSamples(const Pulse& thePulse)
+{
+    return thePulse.data();
+}
+
+inline const double* contiguousSamples(const SegmentedPulse& thePulse)
+{
+    return nullptr;
+}
+
+// Samples of a pulse streamed with addPODContainerSamples() that are kept.
+struct StreamedSamples
+{
+    const std::vector<double>& samples;
+    unsigned long first; //!< Index of samples[0] in the pulse
+};
+
+inline double readSample(const StreamedSamples& thePulse, const unsigned long& i, double& variance)
+{
+    variance = 0;
+    return thePulse.samples[i - thePulse.first];
+}
+
+// Samples [first, last) of a pulse, stored from samples on.
+struct SampleRange
+{
+    unsigned long first;
+    unsigned long last;
+    const double* samples;
+};
+
+// The ranges, in order, outside of which a digitised pulse is its baseline
+// without noise: the photon intervals of a dense pulse, merged where they
+// overlap, and the segments of a segmented pulse, whose gap noise is only
+// drawn for the POD samples. False if these are not known.
+inline bool activeRanges(const Pulse& thePulse, std::vector<SampleRange>& ranges)
+{
+    if (!thePulse.hasBaseline() || thePulse.getBaselineSigma() > 0)
+        return false;
+    std::vector<std::pair<unsigned long, unsigned long>> intervals;
+    for (unsigned int i = 0; i < thePulse.getPhotonSize(); ++i)
+    {
+        unsigned long first = std::min((unsigned long)thePulse.getPhotonIntervalAt(i).first, (unsigned long)thePulse.size());
+        unsigned long last = std::min((unsigned long)thePulse.getPhotonIntervalAt(i).second, (unsigned long)thePulse.size());
+        if (first < last)
+            intervals.push_back(std::make_pair(first, last));
+    }
+    std::sort(intervals.begin(), intervals.end());
+    for (auto& interval : intervals)
+    {
+        if (!ranges.empty() && interval.first <= ranges.back().last)
+            ranges.back().last = std::max(ranges.back().last, interval.second);
+        else
+            ranges.push_back({ interval.first, interval.second, thePulse.data() + interval.first });
+    }
+    return true;
+}
+
+inline bool activeRanges(const SegmentedPulse& thePulse, std::vector<SampleRange>& ranges)
+{
+    for (size_t i = 0; i < thePulse.getNSegments(); ++i)
+    {
+        const SegmentedPulse::Segment& segment = thePulse.getSegment(i);
+        ranges.push_back({ segment.start, segment.end(), segment.samples.data() });
+    }
+    return true;
+}
+
+// The digitiser baseline of a pulse, if it is known.
+inline bool pulseBaseline(const Pulse& thePulse, double& baseline, double& sigma)
+{
+    baseline = thePulse.getBaseline();
+    sigma = thePulse.getBaselineSigma();
+    return thePulse.hasBaseline();
+}
+
+inline bool pulseBaseline(const SegmentedPulse& thePulse, double& baseline, double& sigma)
+{
+    baseline = thePulse.getGapValue();
+    sigma = thePulse.getGapSigma();
+    return true;
+}
+}
+
 void PODContainer::fillPODContainerFromPulse(Pulse& thePulse, std::shared_ptr<MCTruth> theMCTruth, const std::string& LGHG)
+{
+    fillPODContainer(thePulse, theMCTruth, LGHG);
+}
+
+void PODContainer::fillPODContainerFromPulse(
+    const SegmentedPulse& thePulse, std::shared_ptr<MCTruth> theMCTruth, const std::string& LGHG)
+{
+    /**
+     * Same as for a dense pulse. With a fixed baseline only the segments are
+     * scanned. A rolling baseline is updated for every gap sample, which
+     * enters with its variance. Where a POD covers a gap the POD samples are
+     * drawn around the gap value with the gap spread.
+     */
+    fillPODContainer(thePulse, theMCTruth, LGHG);
+}
+
+template <class PulseType>
+void PODContainer::fillPODContainer(const PulseType& thePulse, std::shared_ptr<MCTruth> theMCTruth, const std::string& LGHG)
 {
     /**
      * Supply a pulse as a parameter and form PODs according to the conditions
@@ -47,245 +178,508 @@ void PODContainer::fillPODContainerFromPulse(Pulse& thePulse, std::shared_ptr<MC
      *
      */
 
-    if (thePulse.size() > preTriggerSamples + postTriggerSamples + 1)
+    double baseline = 0;
+    double sigma = 0;
+    if (pulseBaseline(thePulse, baseline, sigma))
+        setBaseline(baseline, sigma);
+    else
+        fHasBaseline = false;
+    beginScan(thePulse.getChannel(), thePulse.getEvent(), thePulse.getLUXSimRunNumber(), thePulse.size(),
+        theMCTruth, LGHG);
+    if (!fScan.active)
+        return;
+
+    //Scan through the Pulse, when POD is found, keep last position.
+    double var = 0;
+    startBaseline(readSample(thePulse, 0, var));
+    const double* samples = contiguousSamples(thePulse);
+    std::vector<SampleRange> ranges;
+    if (fScan.fixedBaseline && elementSamplingRate == 1 && activeRanges(thePulse, ranges))
     {
-        unsigned int pmtNumber = getPmtNumberReal(thePulse.getChannel());
-        unsigned long event = thePulse.getEvent();
-        unsigned int theChannel = 0;
-
-        //Input commands specify the detector subsystem and threshold
-        if (LGHG == "LG")
+        //Only the active ranges can leave the baseline
+        const double sig = podTriggerThreshold * fScan.lrms;
+        unsigned long next = fScan.minWindow;
+        double min = 0;
+        double max = 0;
+        for (auto& range : ranges)
         {
-            podTriggerThreshold = std::stof(global::config->getConfig("TPCLGThresh"));
-            theChannel = getChannelNumberLG(pmtNumber);
+            unsigned long first = std::max(range.first, next);
+            unsigned long last = std::min(range.last, fScan.maxWindow);
+            if (first >= last)
+                continue;
+            skipBaseline(next, first);
+            PulseMath::minMax(range.samples + (first - range.first), last - first, min, max);
+            if (std::abs(min - fScan.bsl) > sig || std::abs(max - fScan.bsl) > sig)
+                scanFixed(range.samples + (first - range.first), first, last - first);
+            else
+                skipBaseline(first, last);
+            next = last;
         }
-        else
+        skipBaseline(next, fScan.maxWindow);
+    }
+    else if (samples && elementSamplingRate == 1)
+        scanSamples(samples + fScan.minWindow, fScan.minWindow, fScan.maxWindow - fScan.minWindow);
+    else
+    {
+        unsigned long first = (fScan.minWindow + elementSamplingRate - 1) / elementSamplingRate * elementSamplingRate;
+        for (unsigned long i = first; i < fScan.maxWindow; i += elementSamplingRate)
         {
-            podTriggerThreshold = std::stof(global::config->getConfig("TPCHGThresh"));
-            theChannel = getChannelNumberHG(pmtNumber);
+            double theVal = readSample(thePulse, i, var);
+            scanSample(i, theVal, var);
         }
+    }
+    endScan();
+
+    //Put all final PODs in theFinalPODs using podStarts and podEnds vectors
+    //and using Resp from thePulse that was given. Output in units of samples
+    if (!fArena)
+        this->reserve(this->size() + podStarts.size());
+    for (int i = 0; i < podStarts.size(); i++)
+        extractPOD(i, thePulse);
+}
+
+void PODContainer::startPODContainer(const unsigned int& pmtChannel, const unsigned long long& event,
+    const int& luxSimRunNumber, const unsigned long& length, std::shared_ptr<MCTruth> theMCTruth,
+    const std::string& LGHG)
+{
+    /**
+     * Start forming PODs from a pulse of the given length whose digitised
+     * samples are supplied in order with addPODContainerSamples(), followed
+     * by finishPODContainer(). The PODs are the same as from
+     * fillPODContainerFromPulse() on the whole pulse, but only the samples
+     * that may still end up in a POD are kept.
+     */
+    fStreamSamples.clear();
+    fStreamFirst = 0;
+    fStreamNext = 0;
+    fStreamExtracted = 0;
+    beginScan(pmtChannel, event, luxSimRunNumber, length, theMCTruth, LGHG);
+}
+
+void PODContainer::addPODContainerSamples(const std::vector<double>& samples)
+{
+    /**
+     * Scan the next samples of the pulse and cut the PODs that are complete.
+     */
+    if (!fScan.active)
+    {
+        fStreamNext += samples.size();
+        return;
+    }
+
+    if (fStreamNext == 0 && !samples.empty())
+        startBaseline(samples[0]);
+    unsigned long first = std::max(fStreamNext, fScan.minWindow);
+    unsigned long last = std::min(fStreamNext + samples.size(), fScan.maxWindow);
+    if (elementSamplingRate == 1)
+    {
+        if (first < last)
+            scanSamples(&samples[first - fStreamNext], first, last - first);
+    }
+    else
+    {
+        first = (first + elementSamplingRate - 1) / elementSamplingRate * elementSamplingRate;
+        for (unsigned long i = first; i < last; i += elementSamplingRate)
+            scanSample(i, samples[i - fStreamNext], 0);
+    }
+    fStreamSamples.insert(fStreamSamples.end(), samples.begin(), samples.end());
+    fStreamNext += samples.size();
+
+    StreamedSamples streamed = { fStreamSamples, fStreamFirst };
+    while (fStreamExtracted < podStarts.size() && podEnds[fStreamExtracted] <= fStreamNext)
+    {
+        extractPOD(fStreamExtracted, streamed);
+        ++fStreamExtracted;
+    }
+
+    //Keep the samples from the start of the next POD that can be formed
+    unsigned long keep = fStreamNext;
+    if (fStreamExtracted < podStarts.size())
+        keep = std::min(keep, (unsigned long)podStarts[fStreamExtracted]);
+    if (fScan.hasGroup)
+        keep = std::min(keep, (unsigned long)(fScan.groupStart < preTriggerSamples ? 0 : fScan.groupStart - preTriggerSamples));
+    unsigned long long nextStart = ((fScan.threshtimer > 0 || fScan.isProtoPod) ? fScan.potentialStart : fStreamNext);
+    keep = std::min(keep, (unsigned long)(nextStart < preTriggerSamples ? 0 : nextStart - preTriggerSamples));
+    if (keep > fStreamFirst && 2 * (keep - fStreamFirst) > fStreamSamples.size())
+    {
+        fStreamSamples.erase(fStreamSamples.begin(), fStreamSamples.begin() + (keep - fStreamFirst));
+        fStreamFirst = keep;
+    }
+}
 
-        int luxSimRunNumber = thePulse.getLUXSimRunNumber();
-        unsigned short theDDC32Number = getDDC32Number(theChannel);
-        unsigned short theDCNumber = getDCNumber(theDDC32Number, theChannel);
-
-        //Scan through the Pulse, when POD is found, keep last position.
-        PODContainer protoPods; //PODs before timing criteria applied
-        unsigned int timeThreshold = std::stoi(global::config->getConfig("ThreshTimer"));
-        bool isAboveThresh = false;
-        unsigned long long threshtimer = 0;
-        unsigned long long potentialStart = 0;
-        bool isProtoPod = false;
-
-        //Baseline trigger calculation mode
-        double sum = 0;
-        double mean = 0;
-        double bsl = thePulse[0];
-        double lrms = std::fabs(thePulse[0]);
-        double ex = exp(-0.5 / (double)timeThreshold);
-        double RMSs = 0.0;
-        double theVal = thePulse[0];
-        double dev = 0;
-        double sig = thePulse[0];
-        double bslHOLD = 0;
-        bool holdbsl = false;
-
-        unsigned long long ctr = 0;
-        unsigned long minWindow = preTriggerSamples;
-        unsigned long maxWindow = thePulse.size() - (postTriggerSamples + 1); //Always positive by convention of pulses always greater at least 1024 in size
-
-        for (unsigned long i = minWindow; i < maxWindow; i++)
+void PODContainer::finishPODContainer()
+{
+    /**
+     * Cut the remaining PODs once all samples of the pulse have been added.
+     * A stream can end before the length given to startPODContainer(), for a
+     * pulse whose length is not known in advance, and the PODs are then cut
+     * at the last sample that was added.
+     */
+    if (fScan.active)
+    {
+        fScan.maxWindow = std::min(fScan.maxWindow, fStreamNext);
+        endScan();
+        for (size_t i = fStreamExtracted; i < podEnds.size(); ++i)
+            podEnds[i] = std::min(podEnds[i], (unsigned long long)fStreamNext);
+        StreamedSamples streamed = { fStreamSamples, fStreamFirst };
+        while (fStreamExtracted < podStarts.size())
         {
-            if (i % elementSamplingRate == 0)
-            {
-                theVal = thePulse[i];
-                //Calculate rolling baseline deviation
-                if (!holdbsl)
-                {
-                    ++ctr;
-                    sum += theVal;
-                    mean = sum / ((double)(ctr));
-                    bsl = mean * (1.0 - ex) + bsl * ex;
-                    RMSs = RMSs + (theVal - bsl) * (theVal - bsl);
-                    double RMS = RMSs / ((double)i + 1.0);
-                    RMS = sqrt(RMS);
-                    lrms = RMS * (1.0 - ex) + lrms * ex;
-                }
-
-                dev = std::abs(theVal - bsl);
-                sig = podTriggerThreshold * lrms;
-
-                if (dev > sig)
-                {
-                    //Something above threshold...
-                    if (threshtimer == 0)
-                    {
-                        //...and first in sequence
-                        potentialStart = i;
-                    }
-                    //Not first in sequence
-                    isAboveThresh = true;
-                    threshtimer += 1;
-                }
-                else
-                {
-                    //std::cout << "Not above threshold" << std::endl;
-                    //Did we already have a POD? If yes, save it!
-                    //Takes care of finding POD and continuing until nothing left
-                    //std::cout << "ThreshTimer " << threshtimer << std::endl;
-                    if (isProtoPod)
-                    {
-                        std::shared_ptr<POD> newlyFoundPOD(new POD());
-                        newlyFoundPOD->setPODStartTimeStamp(potentialStart);
-                        newlyFoundPOD->setPODLength(i - potentialStart);
-                        //Established it's a POD, save as a proto-POD
-                        protoPods.push_back(newlyFoundPOD);
-
-                        isProtoPod = false; //Reset
-                        threshtimer = 0;
-                        potentialStart = 0; //Reset
-                    }
-                    else
-                    {
-                        if (threshtimer > 0)
-                            threshtimer -= 1;
-                    }
-                    isAboveThresh = false;
-                    bslHOLD = false;
-                    holdbsl = false;
-                }
-
-                if (threshtimer >= timeThreshold)
-                {
-                    isProtoPod = true;
-                    bslHOLD = sig;
-                    holdbsl = true;
-                }
-            }
+            extractPOD(fStreamExtracted, streamed);
+            ++fStreamExtracted;
         }
+    }
+    std::vector<double>().swap(fStreamSamples);
+}
+
+void PODContainer::beginScan(const unsigned int& pmtChannel, const unsigned long long& event,
+    const int& luxSimRunNumber, const unsigned long& length, std::shared_ptr<MCTruth> theMCTruth,
+    const std::string& LGHG)
+{
+    fScan.active = (length > preTriggerSamples + postTriggerSamples + 1);
+    if (!fScan.active)
+        return;
+
+    unsigned int pmtNumber = getPmtNumberReal(pmtChannel);
+    fScan.event = event;
+    fScan.channel = 0;
+
+    //Input commands specify the detector subsystem and threshold
+    if (LGHG == "LG")
+    {
+        podTriggerThreshold = std::stof(global::config->getConfig("TPCLGThresh"));
+        fScan.channel = getChannelNumberLG(pmtNumber);
+    }
+    else
+    {
+        podTriggerThreshold = std::stof(global::config->getConfig("TPCHGThresh"));
+        fScan.channel = getChannelNumberHG(pmtNumber);
+    }
+
+    fScan.luxSimRunNumber = luxSimRunNumber;
+    fScan.highGain = (LGHG != "LG");
+    unsigned short theDDC32Number = getDDC32Number(fScan.channel);
+    fScan.dcNumber = getDCNumber(theDDC32Number, fScan.channel);
+    fScan.mcTruth = theMCTruth;
+
+    fScan.timeThreshold = std::stoi(global::config->getConfig("ThreshTimer"));
+    fScan.fixedBaseline = (fHasBaseline && fScan.timeThreshold > 0
+        && global::get_optional_config("PODBaseline", "rolling") == "fixed");
+    fScan.isAboveThresh = false;
+    fScan.threshtimer = 0;
+    fScan.potentialStart = 0;
+    fScan.isProtoPod = false;
+    fScan.hasGroup = false;
+    fScan.groupStart = 0;
+    fScan.groupEnd = 0;
+
+    fScan.minWindow = preTriggerSamples;
+    fScan.maxWindow = length - (postTriggerSamples + 1); //Always positive by convention of pulses always greater at least 1024 in size
+}
+
+void PODContainer::startBaseline(const double& firstSample)
+{
+    //Baseline trigger calculation mode
+    fScan.sum = 0;
+    fScan.mean = 0;
+    fScan.bsl = firstSample;
+    fScan.lrms = std::fabs(fScan.bsl);
+    fScan.ex = exp(-0.5 / (double)fScan.timeThreshold);
+    fScan.RMSs = 0.0;
+    fScan.bslHOLD = 0;
+    fScan.holdbsl = false;
+    fScan.ctr = 0;
+
+    //The digitiser baseline, with its noise and the rounding to ADCC
+    if (fScan.fixedBaseline)
+    {
+        fScan.bsl = fBaseline;
+        fScan.lrms = std::sqrt(fBaselineSigma * fBaselineSigma + 1.0 / 12.0);
+    }
+}
 
-        //It is possible that the code arrives here and there is still
-        //a ProtoPod that was not captured.
-        //This can happen if the signal was a ProtoPod but did not go below
-        //threshold before the end of the loop (given by maxWindow).
-        //Yet, there should be no signal or dark counts beyond maxWindow.
-        //Therefore, if in this case the code arrives here and isProtoPod
-        //is true, the samples corresponding to this waveform should be
-        //saved.
+void PODContainer::scanSample(const unsigned long& i, const double& theVal, const double& var)
+{
+    /**
+     * Trigger logic for sample i of the pulse, which has the value theVal
+     * with variance var.
+     */
+    ScanState& s = fScan;
 
-        if (isProtoPod)
+    //Calculate rolling baseline deviation
+    if (!s.holdbsl && !s.fixedBaseline)
+    {
+        ++s.ctr;
+        s.sum += theVal;
+        s.mean = s.sum / ((double)(s.ctr));
+        s.bsl = s.mean * (1.0 - s.ex) + s.bsl * s.ex;
+        s.RMSs = s.RMSs + (theVal - s.bsl) * (theVal - s.bsl) + var;
+        double RMS = s.RMSs / ((double)i + 1.0);
+        RMS = sqrt(RMS);
+        s.lrms = RMS * (1.0 - s.ex) + s.lrms * s.ex;
+    }
+
+    double dev = std::abs(theVal - s.bsl);
+    double sig = podTriggerThreshold * s.lrms;
+
+    if (dev > sig)
+    {
+        //Something above threshold...
+        if (s.threshtimer == 0)
         {
-            std::shared_ptr<POD> newlyFoundPOD(new POD());
-            newlyFoundPOD->setPODStartTimeStamp(potentialStart);
-            newlyFoundPOD->setPODLength(maxWindow - potentialStart);
-            protoPods.push_back(newlyFoundPOD);
-            isProtoPod = false;
-            threshtimer = 0;
-            potentialStart = 0;
+            //...and first in sequence
+            s.potentialStart = i;
         }
+        //Not first in sequence
+        s.isAboveThresh = true;
+        s.threshtimer += 1;
+    }
+    else
+    {
+        //Did we already have a POD? If yes, save it!
+        //Takes care of finding POD and continuing until nothing left
+        if (s.isProtoPod)
+        {
+            //Established it's a POD, save as a proto-POD
+            addProtoPod(s.potentialStart, i - s.potentialStart);
 
-        //Merge waveforms into PODs as necessary.
-        //The case of > 1 waveform must be clarified here:
-        //Waveforms (W): _/0\_ _/1\_ _/2\_
-        //diffs (D):          0     1
-        //If W0,W1 sufficiently close and if W1,W2 sufficiently close then W0,W1,W2
-        //go together
-        //
-        //If W0,W1 sufficiently close and W1,W2 not sufficiently close then W0,W1
-        //and W2 are the PODs.
-        //
-        //If W0,W1 not sufficiently close and W1,W2 sufficiently close then W0, and
-        //W1,W2 are the PODs.
-        //
-        //If W0,W1 not sufficiently close and W1,W2 not sufficiently close then W0,
-        //and W1 are the PODs, but the loop will miss W2. Therefore add an extra
-        //if(nextPulse <= N) afterwards, to add W2.
-        //
-        //This last case happens because there are protoPods->size()-1 differences
-        //and the loop will not increment to grab the last element if it is too far
-        //away. And the loop will stop at protoPods->size()-2 elements. Therefore the
-        //last element is not in the loop in this case.
-
-        if (protoPods.size())
+            s.isProtoPod = false; //Reset
+            s.threshtimer = 0;
+            s.potentialStart = 0; //Reset
+        }
+        else
         {
-            if (protoPods.size() == 1)
-            {
-                //Exactly 1 POD on channel.
-                unsigned long start1 = protoPods[0]->getPODStartTimeStamp();
-                unsigned long end1 = start1 + protoPods[0]->getPODLength();
+            if (s.threshtimer > 0)
+                s.threshtimer -= 1;
+        }
+        s.isAboveThresh = false;
+        s.bslHOLD = false;
+        s.holdbsl = false;
+    }
+
+    if (s.threshtimer >= s.timeThreshold)
+    {
+        s.isProtoPod = true;
+        s.bslHOLD = sig;
+        s.holdbsl = true;
+    }
+}
 
-                (protoPods[0]->getPODStartTimeStamp() < preTriggerSamples) ? (start1 = 0) : (start1 = protoPods[0]->getPODStartTimeStamp() - preTriggerSamples);
+void PODContainer::scanSamples(const double* samples, const unsigned long& first, const unsigned long& n)
+{
+    /**
+     * Trigger logic for the n consecutive samples from sample first on,
+     * without variance. While a proto-POD holds the baseline, the rolling
+     * baseline and RMS are frozen and the trigger is a comparison with a
+     * fixed window around the baseline, so the samples that stay above
+     * threshold are skipped in bulk.
+     */
+    if (fScan.fixedBaseline)
+    {
+        scanFixed(samples, first, n);
+        return;
+    }
 
-                podStarts.push_back(start1);
-                podEnds.push_back(end1 + postTriggerSamples);
-            }
-            else
+    unsigned long k = 0;
+    while (k < n)
+    {
+        if (fScan.holdbsl)
+        {
+            unsigned long above = PulseMath::findWithin(samples + k, n - k, fScan.bsl, podTriggerThreshold * fScan.lrms);
+            if (above)
             {
-                //More than 1 POD on channel.
-                unsigned long N = protoPods.size() - 1;
-                std::vector<unsigned long> diffs(N, 0);
-
-                for (int i = 0; i < N; i++)
-                {
-
-                    //Calculate time differences between starts and ends.
-                    unsigned long long start2 = protoPods[i + 1]->getPODStartTimeStamp();
-                    unsigned long long end1 = protoPods[i]->getPODStartTimeStamp() + protoPods[i]->getPODLength();
-                    diffs[i] = start2 - end1;
-                }
-
-                int nextPulse = 0;
-                for (int i = 0; i < N; i = ++nextPulse)
-                {
-                    unsigned long start1;
-                    (protoPods[nextPulse]->getPODStartTimeStamp() < preTriggerSamples) ? (start1 = 0) : (start1 = protoPods[nextPulse]->getPODStartTimeStamp() - preTriggerSamples);
-                    podStarts.push_back(start1);
-                    while ((diffs[nextPulse] <= interPodSampleThreshold * elementSamplingRate)
-                        && (nextPulse < N))
-                        nextPulse++;
-                    podEnds.push_back(protoPods[nextPulse]->getPODStartTimeStamp() + protoPods[nextPulse]->getPODLength() + postTriggerSamples);
-                }
-
-                //Last POD, if applicable.
-                if (nextPulse <= N)
-                {
-                    podStarts.push_back(protoPods[nextPulse]->getPODStartTimeStamp() - preTriggerSamples);
-                    podEnds.push_back(protoPods[nextPulse]->getPODStartTimeStamp() + protoPods[nextPulse]->getPODLength() + postTriggerSamples);
-                }
+                fScan.isAboveThresh = true;
+                fScan.threshtimer += above;
+                k += above;
+                if (k == n)
+                    break;
             }
         }
+        scanSample(first + k, samples[k], 0);
+        ++k;
+    }
+}
 
-        //Put all final PODs in theFinalPODs using podStarts and podEnds vectors
-        //and using Resp from thePulse that was given. Output in units of samples
-        //unsigned long prevEND = 0;
-
-        this->resize(podStarts.size());
-        for (int i = 0; i < podStarts.size(); i++)
+void PODContainer::scanFixed(const double* samples, const unsigned long& first, const unsigned long& n)
+{
+    /**
+     * Trigger logic for the n consecutive samples from sample first on,
+     * without variance, with a fixed baseline. The samples within threshold
+     * of it are skipped in bulk. The search bounds are one step inside the
+     * threshold, so that the samples they pass are within threshold exactly
+     * as scanSample() computes it.
+     */
+    const double sig = podTriggerThreshold * fScan.lrms;
+    const double above = std::nextafter(fScan.bsl + sig, -HUGE_VAL);
+    const double below = std::nextafter(fScan.bsl - sig, HUGE_VAL);
+    unsigned long k = 0;
+    while (k < n)
+    {
+        unsigned long within = PulseMath::findCrossing(samples + k, n - k, above);
+        within = PulseMath::findCrossing(samples + k, within, below, false);
+        skipBaseline(first + k, first + k + within);
+        k += within;
+        if (k < n)
         {
-            std::shared_ptr<POD> theNewPOD(new POD());
-            unsigned int podLength = 0;
-            unsigned long podStart = podStarts[i];
-            theNewPOD->resize((podEnds[i] - podStart) / elementSamplingRate);
-            for (unsigned long long j = podStarts[i];
-                 j < podEnds[i];
-                 j += elementSamplingRate)
-            {
-	      theNewPOD->at(j-podStarts[i]) = thePulse[j];
-                podLength++;
-            }
-            theNewPOD->setEvent(event);
-            theNewPOD->setLUXSimRunNumber(luxSimRunNumber);
-            theNewPOD->setChannel(theChannel);
-            theNewPOD->setDataCollector(theDCNumber);
-            theNewPOD->setPODStartTimeStamp(podStart);
-            theNewPOD->setPODLength(podLength / elementSamplingRate);
-            theNewPOD->setHitID(i);
-	    theNewPOD->setMCTruth(theMCTruth);
-            this->at(i) = std::move(theNewPOD);
+            scanSample(first + k, samples[k], 0);
+            ++k;
         }
     }
 }
 
+void PODContainer::skipBaseline(const unsigned long& first, const unsigned long& last)
+{
+    /**
+     * Trigger logic for the samples [first, last), all within threshold of
+     * a fixed baseline, at once: the first of them ends a waveform above
+     * threshold and the others count the threshold timer down.
+     */
+    if (first >= last)
+        return;
+
+    ScanState& s = fScan;
+    if (s.isProtoPod)
+    {
+        addProtoPod(s.potentialStart, first - s.potentialStart);
+        s.isProtoPod = false;
+        s.threshtimer = 0;
+        s.potentialStart = 0;
+    }
+    else
+        s.threshtimer -= std::min(s.threshtimer, (unsigned long long)(last - first));
+    s.isAboveThresh = false;
+    s.bslHOLD = false;
+    s.holdbsl = false;
+}
+
+void PODContainer::addProtoPod(const unsigned long long& start, const unsigned long long& length)
+{
+    /**
+     * Merge waveforms into PODs as necessary. A waveform joins the POD of
+     * the previous one if it starts within the inter-POD threshold of its
+     * end, i.e. for waveforms W0, W1, W2 where W0,W1 and W1,W2 are
+     * sufficiently close, W0,W1,W2 form a single POD. Otherwise the previous
+     * POD is complete and its boundaries, including the pre- and
+     * post-trigger samples, are stored.
+     */
+    if (fScan.hasGroup && start - fScan.groupEnd <= interPodSampleThreshold * elementSamplingRate)
+    {
+        fScan.groupEnd = start + length;
+        return;
+    }
+    if (fScan.hasGroup)
+    {
+        podStarts.push_back(fScan.groupStart < preTriggerSamples ? 0 : fScan.groupStart - preTriggerSamples);
+        podEnds.push_back(fScan.groupEnd + postTriggerSamples);
+    }
+    fScan.hasGroup = true;
+    fScan.groupStart = start;
+    fScan.groupEnd = start + length;
+}
+
+void PODContainer::endScan()
+{
+    //It is possible that the code arrives here and there is still
+    //a ProtoPod that was not captured.
+    //This can happen if the signal was a ProtoPod but did not go below
+    //threshold before the end of the loop (given by maxWindow).
+    //Yet, there should be no signal or dark counts beyond maxWindow.
+    //Therefore, if in this case the code arrives here and isProtoPod
+    //is true, the samples corresponding to this waveform should be
+    //saved.
+
+    if (fScan.isProtoPod)
+    {
+        addProtoPod(fScan.potentialStart, fScan.maxWindow - fScan.potentialStart);
+        fScan.isProtoPod = false;
+        fScan.threshtimer = 0;
+        fScan.potentialStart = 0;
+    }
+
+    //Last POD, if applicable.
+    if (fScan.hasGroup)
+    {
+        podStarts.push_back(fScan.groupStart < preTriggerSamples ? 0 : fScan.groupStart - preTriggerSamples);
+        podEnds.push_back(fScan.groupEnd + postTriggerSamples);
+        fScan.hasGroup = false;
+    }
+}
+
+template <class PulseType>
+void PODContainer::extractPOD(const size_t& podNo, const PulseType& thePulse)
+{
+    /**
+     * Cut POD podNo from thePulse into the arena or, without one, into this
+     * container.
+     */
+    if (fArena)
+        addArenaPOD(podNo, thePulse);
+    else
+        this->push_back(makePOD(podNo, thePulse));
+}
+
+template <class PulseType>
+std::shared_ptr<POD> PODContainer::makePOD(const size_t& podNo, const PulseType& thePulse)
+{
+    /**
+     * Cut POD podNo from thePulse.
+     */
+    std::shared_ptr<POD> theNewPOD(new POD());
+    unsigned int podLength = 0;
+    unsigned long podStart = podStarts[podNo];
+    double var = 0;
+    theNewPOD->resize((podEnds[podNo] - podStart) / elementSamplingRate);
+    for (unsigned long long j = podStarts[podNo];
+         j < podEnds[podNo];
+         j += elementSamplingRate)
+    {
+        double value = readSample(thePulse, j, var);
+        if (var > 0)
+            value = round(gRandom->Gaus(value, sqrt(var)));
+        theNewPOD->at(j - podStarts[podNo]) = value;
+        podLength++;
+    }
+    theNewPOD->setEvent(fScan.event);
+    theNewPOD->setLUXSimRunNumber(fScan.luxSimRunNumber);
+    theNewPOD->setChannel(fScan.channel);
+    theNewPOD->setDataCollector(fScan.dcNumber);
+    theNewPOD->setPODStartTimeStamp(podStart);
+    theNewPOD->setPODLength(podLength / elementSamplingRate);
+    theNewPOD->setHitID(podNo);
+    theNewPOD->setMCTruth(fScan.mcTruth);
+    return theNewPOD;
+}
+
+template <class PulseType>
+void PODContainer::addArenaPOD(const size_t& podNo, const PulseType& thePulse)
+{
+    /**
+     * Cut POD podNo from thePulse into the arena, with the same samples and
+     * metadata as makePOD().
+     */
+    const unsigned long long podStart = podStarts[podNo];
+    const unsigned long long nSamples = (podEnds[podNo] - podStart + elementSamplingRate - 1) / elementSamplingRate;
+    PODArena::Descriptor& thePOD = fArena->addPOD(nSamples);
+    short* samples = fArena->getSamples(thePOD);
+    double var = 0;
+    for (unsigned long long k = 0; k < nSamples; ++k)
+    {
+        double value = readSample(thePulse, podStart + k * elementSamplingRate, var);
+        if (var > 0)
+            value = round(gRandom->Gaus(value, sqrt(var)));
+        samples[k] = value;
+    }
+    thePOD.event = fScan.event;
+    thePOD.luxSimRunNumber = fScan.luxSimRunNumber;
+    thePOD.channel = fScan.channel;
+    thePOD.dataCollector = fScan.dcNumber;
+    thePOD.start = podStart;
+    thePOD.hitID = podNo;
+    thePOD.highGain = fScan.highGain;
+    if (fScan.mcTruth != nullptr)
+        POD::addMCTruth(fScan.mcTruth, thePOD.channel, thePOD.event, thePOD.luxSimRunNumber, thePOD.start,
+            thePOD.length, fArena->getSamplingRate(), thePOD.truthFirst, thePOD.truthLast);
+}
+
 std::shared_ptr<POD> PODContainer::getNextPOD()
 {
     ++timesNextCalled;
@@ -358,6 +752,39 @@ std::shared_ptr<PODContainer> PODContainer::makePODsFromBoundaries(Pulse& thePul
     return thePODs;
 }
 
+std::shared_ptr<PODContainer> PODContainer::makePODsFromBoundaries(std::shared_ptr<SegmentedPulse> thePulse)
+{
+    /**
+     * Cut PODs at the boundaries found by fillPODContainerFromPulse() from
+     * a segmented pulse. Without a pulse the PODs only carry the POD
+     * information and no samples, for stages that were not captured.
+     */
+    std::shared_ptr<PODContainer> thePODs(new PODContainer());
+    thePODs->resize(podStarts.size());
+    for (int i = 0; i < podStarts.size(); i++)
+    {
+        std::shared_ptr<POD> theNewPOD(new POD());
+        unsigned int podLength = 0;
+        if (thePulse)
+            theNewPOD->resize((podEnds[i] - podStarts[i]) / elementSamplingRate);
+        for (unsigned long long j = podStarts[i];
+             j < podEnds[i];
+             j += elementSamplingRate)
+        {
+            if (thePulse)
+                theNewPOD->at(j - podStarts[i]) = thePulse->sample(j);
+            podLength++;
+        }
+        theNewPOD->setEvent(this->at(i)->getEvent());
+        theNewPOD->setChannel(this->at(i)->getChannel());
+        theNewPOD->setPODStartTimeStamp(podStarts[i]);
+        theNewPOD->setPODLength(podLength / elementSamplingRate);
+        theNewPOD->setHitID(i);
+        thePODs->at(i) = theNewPOD;
+    }
+    return thePODs;
+}
+
 void PODContainer::setElementSamplingRate(const int& rate)
 {
     /**
@@ -371,6 +798,27 @@ void PODContainer::setElementSamplingRate(const int& rate)
     elementSamplingRate = rate;
 }
 
+void PODContainer::setArena(PODArena* arena)
+{
+    /**
+     * Add the PODs that are formed to arena rather than to this container.
+     * Passing nullptr stores them in this container again.
+     */
+    fArena = arena;
+}
+
+void PODContainer::setBaseline(const double& baseline, const double& sigma)
+{
+    /**
+     * Set the baseline and noise [ADCC] of the digitiser, for the fixed
+     * baseline trigger of pulses that are streamed. Pulses passed whole
+     * carry their own.
+     */
+    fHasBaseline = true;
+    fBaseline = baseline;
+    fBaselineSigma = sigma;
+}
+
 const std::vector<unsigned long long>& PODContainer::getPodStarts() const
 {
   return podStarts;
@@ -0,0 +1,147 @@
+//
+//  PhotonPrefetcher.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "PhotonPrefetcher.hpp"
+
+PhotonPrefetcher::PhotonPrefetcher(Reader theReader, const std::vector<unsigned long long>& theEvents,
+    const unsigned int& depth)
+    : fReader(theReader)
+    , fEvents(theEvents)
+    , fSlots(depth + 1)
+    , fRead(0)
+    , fReleased(0)
+    , fCurrent(std::numeric_limits<size_t>::max())
+    , fStop(false)
+    , fNEvents(0)
+    , fNWaits(0)
+    , fWaitTime(0)
+{
+    /**
+     * Constructor for PhotonPrefetcher. The worker starts reading theEvents,
+     * in order, at once.
+     */
+    fDirect.evt = std::numeric_limits<unsigned long long>::max();
+    fWorker = std::thread(&PhotonPrefetcher::run, this);
+}
+
+PhotonPrefetcher::~PhotonPrefetcher()
+{
+    /**
+     * Destructor for PhotonPrefetcher. Stops the worker after the event it is
+     * reading.
+     */
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStop = true;
+    }
+    fFreeCondition.notify_all();
+    fWorker.join();
+}
+
+const PhotonPrefetcher::EventPhotons& PhotonPrefetcher::get(const unsigned long long& evt)
+{
+    /**
+     * Returns the photons of evt, valid until get() is called for another
+     * event. The events are expected in the order given to the constructor,
+     * but events may be skipped; the slots of the events before evt are
+     * released. An event that is not ahead is read in the calling thread.
+     */
+    if (fCurrent < fEvents.size() && fEvents[fCurrent] == evt)
+        return fSlots[fCurrent % fSlots.size()].photons;
+    if (fDirect.evt == evt)
+        return fDirect.photons;
+
+    ++fNEvents;
+    size_t i = (fCurrent < fEvents.size() ? fCurrent + 1 : fReleased);
+    while (i < fEvents.size() && fEvents[i] != evt)
+        ++i;
+    if (i == fEvents.size())
+    {
+        std::lock_guard<std::mutex> lock(fReaderMutex);
+        fDirect.evt = evt;
+        fReader(evt, fDirect.photons);
+        return fDirect.photons;
+    }
+
+    std::unique_lock<std::mutex> lock(fMutex);
+    fReleased = i;
+    fCurrent = i;
+    fFreeCondition.notify_all();
+    if (fRead <= i && !fError)
+    {
+        ++fNWaits;
+        auto start = std::chrono::steady_clock::now();
+        fReadCondition.wait(lock, [this, i] { return fRead > i || fError; });
+        fWaitTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    if (fError)
+        std::rethrow_exception(fError);
+    return fSlots[i % fSlots.size()].photons;
+}
+
+unsigned long long PhotonPrefetcher::getNEvents() const
+{
+    return fNEvents;
+}
+
+unsigned long long PhotonPrefetcher::getNWaits() const
+{
+    return fNWaits;
+}
+
+double PhotonPrefetcher::getWaitTime() const
+{
+    return fWaitTime;
+}
+
+void PhotonPrefetcher::run()
+{
+    /**
+     * Read the events in order into the slots, waiting while all slots are
+     * ahead of the event being simulated. The reader runs unlocked: the slot
+     * it fills is not returned by get() until fRead has passed it.
+     * fReaderMutex keeps it from running at the same time as a read in the
+     * calling thread, as the input is not thread safe.
+     */
+    while (true)
+    {
+        size_t i = 0;
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fFreeCondition.wait(lock, [this] { return fStop || fRead < fReleased + fSlots.size(); });
+            // events that were skipped are not read
+            i = std::max(fRead, fReleased);
+            if (fStop || i >= fEvents.size())
+                return;
+        }
+
+        Slot& theSlot = fSlots[i % fSlots.size()];
+        theSlot.evt = fEvents[i];
+        try
+        {
+            std::lock_guard<std::mutex> readerLock(fReaderMutex);
+            fReader(theSlot.evt, theSlot.photons);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fError = std::current_exception();
+            fReadCondition.notify_all();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fRead = i + 1;
+        }
+        fReadCondition.notify_all();
+    }
+}
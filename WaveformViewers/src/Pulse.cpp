@@ -11,12 +11,17 @@
 
 Pulse::Pulse()
     : fLuxSimEvtNumbers()
+    , fLuxSimEvtNumSize(0)
     , fEventID(0)
     , fPulseID(0)
     , fChannel(0)
     , fNextit(1)
     , fLastItPos(0)
     , fLuxSimRunNumber(-1)
+    , fHasBaseline(false)
+    , fBaseline(0)
+    , fBaselineSigma(0)
+    , fOutputSwapped(false)
 {
     /**
      * Constructor for pulse.
@@ -66,17 +71,23 @@ void Pulse::setLUXSimEvtNum(const int& form, const unsigned long long sim, const
 {
     /**
      * Set the LUXSim event to which the pulse belongs.
+     *
+     * The events are stored as ranges of samples: form 0 sets the event
+     * from the first sample up to the next range, form 1 appends a sample
+     * and form 2 sets the event of sample idx only.
      */
     switch (form)
     {
     case 0:
-        fLuxSimEvtNumbers.insert(fLuxSimEvtNumbers.begin(), sim);
+        fLuxSimEvtNumbers[0] = sim;
+        if (fLuxSimEvtNumSize == 0)
+            fLuxSimEvtNumSize = 1;
         break;
     case 1:
-        fLuxSimEvtNumbers.push_back(sim);
+        setLUXSimEvtRange(fLuxSimEvtNumSize, fLuxSimEvtNumSize + 1, sim);
         break;
     case 2:
-        fLuxSimEvtNumbers[idx] = sim;
+        setLUXSimEvtRange(idx, idx + 1, sim);
         break;
     default:
         std::cout << "Invalid option" << std::endl;
@@ -92,10 +103,15 @@ unsigned long long Pulse::getLUXSimEvtNum(const int& form, const unsigned long i
     switch (form)
     {
     case 1:
-        return fLuxSimEvtNumbers[idx];
+    {
+        auto it = fLuxSimEvtNumbers.upper_bound(idx);
+        if (it == fLuxSimEvtNumbers.begin())
+            return 0;
+        return (--it)->second;
         break;
+    }
     case 2:
-        return fLuxSimEvtNumbers.front();
+        return (fLuxSimEvtNumbers.empty() ? 0 : fLuxSimEvtNumbers.begin()->second);
         break;
     default:
         std::cout << "Invalid option" << std::endl;
@@ -107,9 +123,55 @@ unsigned long long Pulse::getLUXSimEvtNum(const int& form, const unsigned long i
 void Pulse::setLUXSimEvtNumSize(const unsigned long& size)
 {
     /**
-     * Set the size of the LUXSimEvtNumber vector.
+     * Set the number of samples covered by the LUXSim event ranges. New
+     * samples continue the last range, or belong to event 0 if there is
+     * none.
      */
-    fLuxSimEvtNumbers.resize(size);
+    if (size == 0)
+        fLuxSimEvtNumbers.clear();
+    else
+    {
+        fLuxSimEvtNumbers.erase(fLuxSimEvtNumbers.lower_bound(size), fLuxSimEvtNumbers.end());
+        if (fLuxSimEvtNumbers.empty())
+            fLuxSimEvtNumbers[0] = 0;
+    }
+    fLuxSimEvtNumSize = size;
+}
+
+void Pulse::setLUXSimEvtRange(const unsigned long& first, const unsigned long& last, const unsigned long long sim)
+{
+    /**
+     * Assign the LUXSim event sim to the samples [first, last). Samples
+     * beyond the current size that are skipped belong to event 0.
+     */
+    if (first >= last)
+        return;
+
+    unsigned long long after = getLUXSimEvtNum(1, last);
+    bool restoreAfter = last < fLuxSimEvtNumSize && fLuxSimEvtNumbers.find(last) == fLuxSimEvtNumbers.end();
+    if (first > fLuxSimEvtNumSize && getLUXSimEvtNum(1, fLuxSimEvtNumSize) != 0)
+        fLuxSimEvtNumbers[fLuxSimEvtNumSize] = 0;
+
+    fLuxSimEvtNumbers.erase(fLuxSimEvtNumbers.lower_bound(first), fLuxSimEvtNumbers.lower_bound(last));
+    if (restoreAfter && after != sim)
+        fLuxSimEvtNumbers[last] = after;
+    auto next = fLuxSimEvtNumbers.find(last);
+    if (next != fLuxSimEvtNumbers.end() && next->second == sim)
+        fLuxSimEvtNumbers.erase(next);
+
+    auto prev = fLuxSimEvtNumbers.upper_bound(first);
+    if (prev == fLuxSimEvtNumbers.begin() || (--prev)->second != sim)
+        fLuxSimEvtNumbers[first] = sim;
+
+    fLuxSimEvtNumSize = std::max(fLuxSimEvtNumSize, last);
+}
+
+size_t Pulse::getNLUXSimEvtRanges() const
+{
+    /**
+     * Number of ranges of consecutive samples from the same LUXSim event.
+     */
+    return fLuxSimEvtNumbers.size();
 }
 
 void Pulse::setLUXSimRunNumber(int rnum)
@@ -221,10 +283,102 @@ void Pulse::findNextFilterSample(unsigned int& intervalNo, unsigned int& sampleN
     }
 }
 
-const std::vector<double>& Pulse::getSamples() const
+const PulseSamples& Pulse::getSamples() const
 {
     /**
      * Get the vector of ADCC values of the POD.
      */
-  return dynamic_cast<const std::vector<double> &>(*this);
+  return dynamic_cast<const PulseSamples &>(*this);
+}
+
+void Pulse::clearPhotonIntervals()
+{
+  fPhotonIntervals.clear();
+  fOverlappingIntervals.clear();
+}
+
+void Pulse::setBaseline(const double& baseline, const double& sigma)
+{
+    /**
+     * Set by the digitiser: outside the photon intervals, which are then in
+     * digitised samples, every sample is the baseline with Gaussian noise of
+     * the given spread [ADCC].
+     */
+    fHasBaseline = true;
+    fBaseline = baseline;
+    fBaselineSigma = sigma;
+}
+
+void Pulse::clearBaseline()
+{
+    fHasBaseline = false;
+    fBaseline = 0;
+    fBaselineSigma = 0;
+}
+
+bool Pulse::hasBaseline() const
+{
+    return fHasBaseline;
+}
+
+double Pulse::getBaseline() const
+{
+    return fBaseline;
+}
+
+double Pulse::getBaselineSigma() const
+{
+    return fBaselineSigma;
+}
+
+void Pulse::assignTouched(const Pulse& other)
+{
+    /**
+     * Copy other into this pulse, which must hold only zeros, by copying
+     * only the samples inside the photon intervals of other. Before
+     * digitisation a pulse is zero outside its photon intervals, so this
+     * is equivalent to a full copy.
+     */
+    resize(other.size());
+    for (auto& interval : other.fPhotonIntervals)
+    {
+        unsigned long first = std::min((unsigned long)interval.first, (unsigned long)size());
+        unsigned long second = std::min((unsigned long)interval.second, (unsigned long)size());
+        if (first < second)
+            std::copy(other.begin() + first, other.begin() + second, begin() + first);
+    }
+
+    fEventID = other.fEventID;
+    fPulseID = other.fPulseID;
+    fChannel = other.fChannel;
+    fNextit = other.fNextit;
+    fLastItPos = other.fLastItPos;
+    fLuxSimRunNumber = other.fLuxSimRunNumber;
+    fLuxSimEvtNumbers = other.fLuxSimEvtNumbers;
+    fLuxSimEvtNumSize = other.fLuxSimEvtNumSize;
+    fPhotonIntervals = other.fPhotonIntervals;
+    fOverlappingIntervals = other.fOverlappingIntervals;
+    fHasBaseline = other.fHasBaseline;
+    fBaseline = other.fBaseline;
+    fBaselineSigma = other.fBaselineSigma;
+}
+
+PulseSamples& Pulse::getOutputBuffer()
+{
+    /**
+     * Buffer that a stage changing the pulse length can fill and then swap
+     * in with swapOutputBuffer(), instead of resizing the pulse in place.
+     */
+    return fOutputBuffer;
+}
+
+void Pulse::swapOutputBuffer()
+{
+    PulseSamples::swap(fOutputBuffer);
+    fOutputSwapped = !fOutputSwapped;
+}
+
+bool Pulse::isOutputBufferSwapped() const
+{
+    return fOutputSwapped;
 }
@@ -18,21 +18,6 @@ struct ProtoPulseData
     double wavelength;
 };
 
-inline unsigned long long
-pow2roundup(unsigned long long x)
-{
-    /**
-     * Round up to the nearest power of 2 for the parameter given.
-     */
-    --x;
-    x |= x >> 1;
-    x |= x >> 2;
-    x |= x >> 4;
-    x |= x >> 8;
-    x |= x >> 16;
-    return x + 1;
-}
-
 bool CompareProtoPulseData(ProtoPulseData const& lhs,
     ProtoPulseData const& rhs)
 {
@@ -116,14 +101,17 @@ void PulseManager::PrepareEventBounds(Pulse& thePulse,
 
     beginSubset = TMin * simPrecision;
 
-    //Endsubset either takes the nearest power of 2, or a padded version of the
-    //maximum photon time in the event.
+    //Endsubset is a padded version of the maximum photon time in the event.
+    //AUTO no longer rounds up to a power of 2: only the FFT needs that, and
+    //it pads its own copy of the data.
+    unsigned long long autoEndSubset = TMax * simPrecision + SubsetIncrement;
+    endSubset = autoEndSubset;
     auto config = global::config;
     try
     {
         if (config->getConfig("PulsePadding") == "AUTO")
         {
-            endSubset = pow2roundup(TMax * simPrecision + SubsetIncrement);
+            endSubset = autoEndSubset;
         }
         else if (config->getConfig("PulsePadding") == "SMOOTH")
         {
@@ -156,7 +144,7 @@ void PulseManager::PrepareEventBounds(Pulse& thePulse,
             std::cout << "A user input error is assumed." << std::endl;
             std::cout << "Will continue with PulsePadding set to AUTO." << std::endl;
             std::cout << "PulsePadding setting will not be recorded in output!" << std::endl;
-            endSubset = pow2roundup(TMax * simPrecision + SubsetIncrement);
+            endSubset = autoEndSubset;
         }
     }
     catch (...)
@@ -167,14 +155,9 @@ void PulseManager::PrepareEventBounds(Pulse& thePulse,
         std::cout << "PulsePadding setting will not be recorded in output!" << std::endl;
     }
 
-    thePulse.resize((endSubset - beginSubset) * simPrecision);
-    thePulse.setLUXSimEvtNumSize((endSubset - beginSubset) * simPrecision);
-
-    for (unsigned long i = 0; i < thePulse.size(); i++)
-    {
-        thePulse[i] = 0;
-        thePulse.setLUXSimEvtNum(2, 0, i);
-    }
+    thePulse.assign((endSubset - beginSubset) * simPrecision, 0);
+    thePulse.setLUXSimEvtNumSize(0);
+    thePulse.setLUXSimEvtRange(0, thePulse.size(), 0);
 }
 
 void PulseManager::preparePulse()
@@ -0,0 +1,222 @@
+//
+//  PulseMath.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "PulseMath.hpp"
+
+namespace PulseMath
+{
+
+void add(double* a, const double* b, const size_t& n)
+{
+    size_t i = 0;
+#if defined(__AVX__)
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(a + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+#endif
+    for (; i < n; ++i)
+        a[i] += b[i];
+}
+
+void subtract(double* a, const double* b, const size_t& n)
+{
+    size_t i = 0;
+#if defined(__AVX__)
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(a + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+#endif
+    for (; i < n; ++i)
+        a[i] -= b[i];
+}
+
+void addScaled(double* a, const double* b, const double& scale, const size_t& n)
+{
+    size_t i = 0;
+#if defined(__AVX__)
+    const __m256d s = _mm256_set1_pd(scale);
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(a + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_mul_pd(s, _mm256_loadu_pd(b + i))));
+#endif
+    for (; i < n; ++i)
+        a[i] += scale * b[i];
+}
+
+void scale(double* a, const double& scale, const size_t& n)
+{
+    size_t i = 0;
+#if defined(__AVX__)
+    const __m256d s = _mm256_set1_pd(scale);
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(a + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), s));
+#endif
+    for (; i < n; ++i)
+        a[i] *= scale;
+}
+
+void minMax(const double* a, const size_t& n, double& min, double& max)
+{
+    /**
+     * Smallest and largest of the n values. For n = 0, min is +inf and max
+     * is -inf.
+     */
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -lo;
+    size_t i = 0;
+#if defined(__AVX__)
+    if (n >= 4)
+    {
+        __m256d vlo = _mm256_set1_pd(lo);
+        __m256d vhi = _mm256_set1_pd(hi);
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256d v = _mm256_loadu_pd(a + i);
+            vlo = _mm256_min_pd(vlo, v);
+            vhi = _mm256_max_pd(vhi, v);
+        }
+        double l[4], h[4];
+        _mm256_storeu_pd(l, vlo);
+        _mm256_storeu_pd(h, vhi);
+        for (int k = 0; k < 4; ++k)
+        {
+            lo = (l[k] < lo ? l[k] : lo);
+            hi = (h[k] > hi ? h[k] : hi);
+        }
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        lo = (a[i] < lo ? a[i] : lo);
+        hi = (a[i] > hi ? a[i] : hi);
+    }
+    min = lo;
+    max = hi;
+}
+
+double sum(const double* a, const size_t& n)
+{
+    /**
+     * Sum of the n values, accumulated in four lanes (sample i in lane
+     * i % 4) which are combined as (l0 + l1) + (l2 + l3).
+     */
+    double lane[4] = { 0, 0, 0, 0 };
+    size_t i = 0;
+#if defined(__AVX__)
+    __m256d acc = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm256_add_pd(acc, _mm256_loadu_pd(a + i));
+    _mm256_storeu_pd(lane, acc);
+#else
+    for (; i + 4 <= n; i += 4)
+    {
+        lane[0] += a[i];
+        lane[1] += a[i + 1];
+        lane[2] += a[i + 2];
+        lane[3] += a[i + 3];
+    }
+#endif
+    for (int k = 0; i < n; ++i, ++k)
+        lane[k] += a[i];
+    return (lane[0] + lane[1]) + (lane[2] + lane[3]);
+}
+
+size_t findCrossing(const double* a, const size_t& n, const double& threshold, const bool& above)
+{
+    /**
+     * Index of the first value above (or, if above is false, below) the
+     * threshold, or n if there is none.
+     */
+    size_t i = 0;
+#if defined(__AVX__)
+    const __m256d t = _mm256_set1_pd(threshold);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d v = _mm256_loadu_pd(a + i);
+        int mask = _mm256_movemask_pd(above ? _mm256_cmp_pd(v, t, _CMP_GT_OQ) : _mm256_cmp_pd(v, t, _CMP_LT_OQ));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+    if (above)
+    {
+        for (; i < n; ++i)
+            if (a[i] > threshold)
+                return i;
+    }
+    else
+    {
+        for (; i < n; ++i)
+            if (a[i] < threshold)
+                return i;
+    }
+    return n;
+}
+
+size_t findCrossing(const short* a, const size_t& n, const short& threshold, const bool& above)
+{
+    /**
+     * As for double values, eight samples at a time.
+     */
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i t = _mm_set1_epi16(threshold);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(a + i));
+        int mask = _mm_movemask_epi8(above ? _mm_cmpgt_epi16(v, t) : _mm_cmplt_epi16(v, t));
+        if (mask)
+            return i + __builtin_ctz(mask) / 2;
+    }
+#endif
+    if (above)
+    {
+        for (; i < n; ++i)
+            if (a[i] > threshold)
+                return i;
+    }
+    else
+    {
+        for (; i < n; ++i)
+            if (a[i] < threshold)
+                return i;
+    }
+    return n;
+}
+
+size_t findWithin(const double* a, const size_t& n, const double& centre, const double& halfWidth)
+{
+    /**
+     * Index of the first value that is not further than halfWidth from
+     * centre, i.e. for which !(|a[i] - centre| > halfWidth), or n if there
+     * is none.
+     */
+    size_t i = 0;
+#if defined(__AVX__)
+    const __m256d c = _mm256_set1_pd(centre);
+    const __m256d h = _mm256_set1_pd(halfWidth);
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d d = _mm256_andnot_pd(signBit, _mm256_sub_pd(_mm256_loadu_pd(a + i), c));
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(d, h, _CMP_NGT_UQ));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+    for (; i < n; ++i)
+        if (!(std::abs(a[i] - centre) > halfWidth))
+            return i;
+    return n;
+}
+}
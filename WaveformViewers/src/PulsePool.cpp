@@ -0,0 +1,97 @@
+//
+//  PulsePool.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <algorithm>
+
+#include "PulsePool.hpp"
+
+PulsePool::PulsePool()
+    : fNZeroedSamples(0)
+{
+    /**
+     * Constructor for PulsePool.
+     */
+}
+
+PulsePool::~PulsePool()
+{
+    /**
+     * Destructor for PulsePool.
+     */
+}
+
+std::shared_ptr<Pulse> PulsePool::acquire(const unsigned long& size)
+{
+    /**
+     * Return a pulse of the given size holding only zeros. Only samples
+     * beyond the previous size of a reused pulse need to be initialised.
+     */
+    std::shared_ptr<Pulse> thePulse;
+    if (fFree.empty())
+        thePulse = std::make_shared<Pulse>();
+    else
+    {
+        thePulse = fFree.back();
+        fFree.pop_back();
+    }
+    thePulse->resize(size);
+    return thePulse;
+}
+
+void PulsePool::release(std::shared_ptr<Pulse>& thePulse)
+{
+    /**
+     * Return a pulse to the pool. Pulses that are still shared elsewhere
+     * are not reused. The pointer is reset in all cases.
+     */
+    if (!thePulse)
+        return;
+    if (thePulse.use_count() > 1)
+    {
+        thePulse.reset();
+        return;
+    }
+
+    if (thePulse->isOutputBufferSwapped())
+    {
+        thePulse->swapOutputBuffer();
+    }
+    else
+    {
+        for (size_t i = 0; i < thePulse->getPhotonSize(); ++i)
+        {
+            unsigned long first = std::min((unsigned long)thePulse->getPhotonIntervalAt(i).first,
+                (unsigned long)thePulse->size());
+            unsigned long second = std::min((unsigned long)thePulse->getPhotonIntervalAt(i).second,
+                (unsigned long)thePulse->size());
+            if (first < second)
+            {
+                std::fill(thePulse->begin() + first, thePulse->begin() + second, 0.0);
+                fNZeroedSamples += second - first;
+            }
+        }
+    }
+
+    thePulse->clearPhotonIntervals();
+    thePulse->clearBaseline();
+    thePulse->setLUXSimEvtNumSize(0);
+    thePulse->setChannel(0);
+    thePulse->setEvent(0);
+
+    fFree.push_back(thePulse);
+    thePulse.reset();
+}
+
+size_t PulsePool::getNFree() const
+{
+    return fFree.size();
+}
+
+unsigned long long PulsePool::getNZeroedSamples() const
+{
+    return fNZeroedSamples;
+}
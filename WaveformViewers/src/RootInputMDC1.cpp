@@ -81,13 +81,7 @@ int RootInputMDC1::makePMTDataReady()
         //Add new available PMTs
         //Can turn this into a set.
 
-        //Create list of empty events
-        if (!BaccObj->photons.size()
-            || ((BaccObj->fEventLastPhotonTime_ns) - (BaccObj->fEventFirstPhotonTime_ns)) >= PhotonTimeLimit)
-        {
-            EmptyEvents.push_back(i);
-        }
-
+        std::set<int> hitPMTs;
         for (int k = 0; k < BaccObj->photons.size(); k++)
         {
             if (AvailablePMTs.size() == 0)
@@ -104,14 +98,17 @@ int RootInputMDC1::makePMTDataReady()
             {
                 AvailablePMTs.push_back(BaccObj->photons[k].iPMTIndex);
             }
+            hitPMTs.insert(BaccObj->photons[k].iPMTIndex);
         }
 
         //Get all availble Events.
         //Removed check for whether event is a new one from previous implementations
         //see for example RootInputOct2016, as the new input structure guarantees
         //that every entry  is a new event. This also allows us to use the index
-        //as event identifier.
-        AvailableEvents.push_back(i);
+        //as event identifier. Empty events are listed too.
+        double timeSpan = (BaccObj->fEventLastPhotonTime_ns) - (BaccObj->fEventFirstPhotonTime_ns);
+        addAvailableEvent(i, BaccObj->photons.size(), hitPMTs.size(), timeSpan,
+            !BaccObj->photons.size() || timeSpan >= PhotonTimeLimit);
     }
     EvtStartIdx.push_back(fMCTruthEvent->GetEntries());
 
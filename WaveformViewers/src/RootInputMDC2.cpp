@@ -6,6 +6,15 @@
 //  Copyright © 2018 LZOxford. All rights reserved.
 //
 
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <sys/stat.h>
+
+#include "TROOT.h"
+
 #include "RootInputMDC2.hpp"
 //#include "PMT.hpp"
 
@@ -13,10 +22,83 @@
 #define BACC_LIB_VERSION __BACC_LIB_REV
 #endif
 
+namespace
+{
+// Members of PhotonMCTruth that are read from split PMTStream trees.
+const char* kPhotonMembers[] = { "fTime_ns", "fWavelength_nm", "iInteractionIdentifier", "iVertexNumber", "iPulseID" };
+
+// Members of BaccMCTruthEvent that are read by the startup scan.
+const char* kScanMembers[] = { "iPMTHits", "fEventFirstPhotonTime_ns", "fEventLastPhotonTime_ns", "fParentTime_ns",
+    "fReferencePhotonTime_ns" };
+
+// Sidecar event index: magic, format version and the bytes at each end of
+// an input file that go into its checksum.
+const char kEventIndexMagic[8] = { 'D', 'E', 'R', 'I', 'D', 'X', '\0', '\0' };
+const std::uint32_t kEventIndexVersion = 3;
+const std::streamoff kChecksumBlock = 1 << 20;
+
+// Event indexes kept in memory for the next runs of a resident DER
+const size_t kMaxResidentIndexes = 16;
+
+bool isSplit(TTree* theTree, const char* branchName)
+{
+    TBranch* theBranch = theTree->GetBranch(branchName);
+    return theBranch && theBranch->GetListOfBranches() && theBranch->GetListOfBranches()->GetEntriesFast() > 0;
+}
+
+TBranch* findMember(TTree* theTree, const char* branchName, const std::string& member)
+{
+    // Sub-branch of a split branch, named member or branchName.member
+    TBranch* theBranch = theTree->GetBranch(branchName);
+    if (!theBranch || !theBranch->GetListOfBranches())
+        return nullptr;
+    for (int i = 0; i < theBranch->GetListOfBranches()->GetEntriesFast(); i++)
+    {
+        TObject* theObject = theBranch->GetListOfBranches()->At(i);
+        std::string name = theObject->GetName();
+        if (name == member
+            || (name.size() > member.size() && name.compare(name.size() - member.size() - 1, std::string::npos, "." + member) == 0))
+            return (TBranch*)theObject;
+    }
+    return nullptr;
+}
+
+void fnv1a(std::uint64_t& hash, const char* bytes, const size_t& n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        hash ^= (unsigned char)bytes[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+template <typename T>
+void writeBlock(std::ofstream& theFile, const std::vector<T>& theValues)
+{
+    std::uint64_t n = theValues.size();
+    theFile.write((const char*)&n, sizeof(n));
+    theFile.write((const char*)theValues.data(), n * sizeof(T));
+}
+
+template <typename T>
+bool readBlock(std::ifstream& theFile, std::vector<T>& theValues)
+{
+    std::uint64_t n = 0;
+    if (!theFile.read((char*)&n, sizeof(n)))
+        return false;
+    theValues.resize(n);
+    return (bool)theFile.read((char*)theValues.data(), n * sizeof(T));
+}
+}
+
 #if (BACC_LIB_VERSION == 6)
+std::map<std::string, std::pair<unsigned long long, RootInputMDC2::EventIndex>> RootInputMDC2::fResidentIndexes;
+
 RootInputMDC2::RootInputMDC2()
-    : BaccObj(0)
-    , pmthits(0)
+    : fPMTStreamCacheSize(0)
+    , fNChannels(0)
+    , fUnzipThreads(0)
+    , BaccObj(0)
 {
     /**
      * Constructor for RootInputMDC2.
@@ -26,6 +108,9 @@ RootInputMDC2::RootInputMDC2()
 }
 #else
 RootInputMDC2::RootInputMDC2()
+    : fPMTStreamCacheSize(0)
+    , fNChannels(0)
+    , fUnzipThreads(0)
 {
     /**
      * Constructor for RootInputMDC2.
@@ -41,7 +126,7 @@ RootInputMDC2::~RootInputMDC2()
      * Destructor for RootInputMDC2.
      */
 #if (BACC_LIB_VERSION == 6)
-    delete pmthits;
+    Close();
     delete data;
 #endif
 }
@@ -81,49 +166,540 @@ bool RootInputMDC2::Open()
 void RootInputMDC2::Close()
 {
     /**
-     * Close the root file. No need to close when using TChain.
+     * Close the root file. No need to close when using TChain, but the
+     * PMTStream chains are released, which closes their files. The
+     * prefetcher is stopped first, as it reads from them.
+     */
+    stopPrefetch();
+#if (BACC_LIB_VERSION == 6)
+    for (auto& theStream : fPMTStreams)
+    {
+        delete theStream.second.chain;
+        delete theStream.second.hits;
+    }
+    fPMTStreams.clear();
+#endif
+}
+
+bool RootInputMDC2::readsEventPhotons() const
+{
+#if (BACC_LIB_VERSION == 6)
+    return true;
+#endif
+    return false;
+}
+
+void RootInputMDC2::readEventPhotons(const unsigned long long& evt, PhotonPrefetcher::EventPhotons& thePhotons)
+{
+    /**
+     * Read the photons of the PMTs of evt, in the order of EventAndPMTInfos.
+     * Only the PMTStream chains are read, not MCTruthTree, so this may run
+     * in the prefetch thread while the simulation reads the event.
+     */
+#if (BACC_LIB_VERSION == 6)
+    const std::vector<PMTStreamInfo>& theInfos = EventAndPMTInfos[evt];
+    if (thePhotons.size() < theInfos.size())
+        thePhotons.resize(theInfos.size());
+    for (size_t k = 0; k < theInfos.size(); k++)
+    {
+        readPhotons(theInfos[k], fPhotonTimeCut[evt], thePhotons[k]);
+    }
+#endif
+}
+
+#if (BACC_LIB_VERSION == 6)
+RootInputMDC2::PMTStream& RootInputMDC2::seekPMTStream(const PMTStreamInfo& info)
+{
+    /**
+     * Returns the chain of the PMTStream tree of the PMT of info. The chain
+     * is made on first use and kept for the rest of the run, with the branch
+     * address bound once, and has a TTreeCache of PMTStreamCacheSize bytes
+     * that cachePhotons() points at the entries to be read.
+     */
+    auto it = fPMTStreams.find(info.PMTnumber);
+    if (it == fPMTStreams.end())
+    {
+        PMTStream& theNewStream = fPMTStreams[info.PMTnumber];
+        theNewStream.chain = new TChain(("PMTStream" + std::to_string(info.PMTnumber)).c_str());
+        theNewStream.hits = 0;
+        theNewStream.timeBranch = nullptr;
+        theNewStream.treeNumber = -1;
+        theNewStream.timesCached = false;
+        for (int i = 0; i < filePath.size(); i++)
+        {
+            theNewStream.chain->Add(filePath[i].c_str());
+        }
+        theNewStream.chain->SetBranchAddress("PhotonMCTruth", &theNewStream.hits);
+        if (fUnzipThreads > 0)
+        { // the cache made below then unzips its baskets in the ROOT thread pool
+            theNewStream.chain->SetImplicitMT(false);
+            theNewStream.chain->SetParallelUnzip(true);
+        }
+
+        // If PhotonMCTruth is split, only the members that are used are
+        // read and cached, and the other baskets are never unzipped.
+        bool photonsSplit = isSplit(theNewStream.chain, "PhotonMCTruth");
+        theNewStream.split = photonsSplit;
+        if (photonsSplit)
+        {
+            theNewStream.chain->SetBranchStatus("*", false);
+            for (const char* member : kPhotonMembers)
+                theNewStream.chain->SetBranchStatus((std::string("*") + member).c_str(), true);
+        }
+        if (fPMTStreamCacheSize > 0)
+        {
+            theNewStream.chain->SetCacheSize(fPMTStreamCacheSize);
+            if (photonsSplit)
+            {
+                for (const char* member : kPhotonMembers)
+                    theNewStream.chain->AddBranchToCache((std::string("*") + member).c_str(), true);
+            }
+            else
+                theNewStream.chain->AddBranchToCache("*", true);
+            theNewStream.chain->StopCacheLearningPhase();
+        }
+        it = fPMTStreams.find(info.PMTnumber);
+    }
+
+    return it->second;
+}
+
+void RootInputMDC2::cachePhotons(PMTStream& theStream, const long long& first, const long long& end, const bool& timesOnly)
+{
+    /**
+     * Point the TTreeCache of theStream at the entries from first to end,
+     * so that only their baskets are read and unzipped, cluster by cluster.
+     * If PhotonMCTruth is split the cache holds either the photon times
+     * alone or all members that are read.
+     */
+    if (fPMTStreamCacheSize <= 0 || first >= end)
+        return;
+    theStream.chain->LoadTree(first); // the cache belongs to the file of the first entry
+    if (theStream.split && theStream.timesCached != timesOnly)
+    {
+        theStream.chain->DropBranchFromCache("*", true);
+        for (const char* member : kPhotonMembers)
+        {
+            if (!timesOnly || std::string(member) == "fTime_ns")
+                theStream.chain->AddBranchToCache((std::string("*") + member).c_str(), true);
+        }
+        theStream.timesCached = timesOnly;
+    }
+    theStream.chain->SetCacheEntryRange(first, end);
+}
+
+void RootInputMDC2::readPhotons(const PMTStreamInfo& info, const double& timeCut,
+    PhotonPrefetcher::PhotonColumns& thePhotons)
+{
+    /**
+     * Read the photons of the PMT and event of info into thePhotons, whose
+     * arrays are reused. The entry range is read in order through the
+     * cache of the PMT's chain.
+     *
+     * Photons later than timeCut are outside the simulated window and are
+     * left out. If PhotonMCTruth is split, the times are read first with
+     * only they in the cache. The other members are then cached and read
+     * from the first to the last photon that is kept, so their baskets are
+     * not read or unzipped past the window.
+     */
+    PMTStream& theStream = seekPMTStream(info);
+    size_t n = info.NumberOfPhotons;
+    thePhotons.pmt = info.PMTnumber;
+    thePhotons.time.resize(n);
+    thePhotons.wavelength.resize(n);
+    thePhotons.interactionID.resize(n);
+    thePhotons.vertexNumber.resize(n);
+    thePhotons.pulseID.resize(n);
+
+    std::vector<unsigned int>& theKept = theStream.kept;
+    theKept.clear();
+    bool pushDown = (timeCut < std::numeric_limits<double>::max() && theStream.split);
+    if (pushDown)
+    {
+        cachePhotons(theStream, info.StartIdx, info.StartIdx + n, true);
+        for (size_t i = 0; i < n; i++)
+        {
+            long long entry = theStream.chain->LoadTree(info.StartIdx + i);
+            if (theStream.chain->GetTreeNumber() != theStream.treeNumber)
+            {
+                theStream.treeNumber = theStream.chain->GetTreeNumber();
+                theStream.timeBranch = findMember(theStream.chain->GetTree(), "PhotonMCTruth", "fTime_ns");
+            }
+            if (!theStream.timeBranch)
+            {
+                pushDown = false;
+                break;
+            }
+            theStream.timeBranch->GetEntry(entry);
+            if (theStream.hits->fTime_ns <= timeCut)
+                theKept.push_back(i);
+        }
+    }
+    if (!pushDown)
+        cachePhotons(theStream, info.StartIdx, info.StartIdx + n, false);
+    else if (!theKept.empty())
+        cachePhotons(theStream, info.StartIdx + theKept.front(), info.StartIdx + theKept.back() + 1, false);
+
+    size_t nKept = (pushDown ? theKept.size() : n);
+    size_t k = 0;
+    for (size_t j = 0; j < nKept; j++)
+    {
+        size_t i = (pushDown ? theKept[j] : j);
+        theStream.chain->GetEntry(info.StartIdx + i);
+        const PhotonMCTruth* theHit = theStream.hits;
+        if (theHit->fTime_ns > timeCut)
+            continue;
+        thePhotons.time[k] = theHit->fTime_ns;
+        thePhotons.wavelength[k] = theHit->fWavelength_nm;
+        thePhotons.interactionID[k] = theHit->iInteractionIdentifier;
+        thePhotons.vertexNumber[k] = theHit->iVertexNumber;
+        thePhotons.pulseID[k] = theHit->iPulseID;
+        ++k;
+    }
+    thePhotons.time.resize(k);
+    thePhotons.wavelength.resize(k);
+    thePhotons.interactionID.resize(k);
+    thePhotons.vertexNumber.resize(k);
+    thePhotons.pulseID.resize(k);
+}
+
+void RootInputMDC2::enableParallelUnzip(const unsigned int& nThreads)
+{
+    /**
+     * Unzip the baskets of the input in a ROOT thread pool of nThreads
+     * threads, which is separate from the simulation threads. Only the
+     * baskets read through a TTreeCache are unzipped in the pool; entries
+     * are still read on the calling thread, branch by branch.
+     */
+    if (nThreads == 0)
+        return;
+#ifdef R__USE_IMT
+    if (!ROOT::IsImplicitMTEnabled())
+        ROOT::EnableImplicitMT(nThreads);
+    fUnzipThreads = ROOT::GetThreadPoolSize();
+    data->SetImplicitMT(false);
+    data->SetParallelUnzip(true);
+    std::cout << "Unzipping input baskets in " << fUnzipThreads << " threads" << std::endl;
+    if (fPMTStreamCacheSize <= 0)
+        std::cout << "NOTICE: PMTStreamCacheSize is 0, so photons are unzipped on the reading thread" << std::endl;
+#else
+    std::cout << "NOTICE: ROOT is built without implicit multithreading, unzipping input on the reading thread"
+              << std::endl;
+#endif
+}
+
+void RootInputMDC2::scanEvents(EventIndex& theIndex, const unsigned int& nThreads)
+{
+    /**
+     * Scan MCTruthTree for the hit PMTs and photon times of every event. The
+     * entries are split into contiguous ranges, one per thread, each read
+     * through its own chain. If MCTruthEvent is split, only the members in
+     * kScanMembers are read, so the vertices and photons are never unzipped.
      */
+    long long N = data->GetEntries();
+    theIndex.firstPhotonTime.assign(N, 0);
+    theIndex.lastPhotonTime.assign(N, 0);
+    theIndex.parentTime.assign(N, 0);
+    theIndex.referenceTime.assign(N, 0);
+    std::vector<std::vector<std::pair<int, int>>> theHits(N);
+
+    unsigned int nWorkers = (unsigned int)std::max(1LL, std::min((long long)nThreads, N));
+    std::vector<unsigned int> nChannels(nWorkers, 0);
+    if (nWorkers > 1)
+        ROOT::EnableThreadSafety();
+
+    auto scanRange = [&](const unsigned int worker, const long long first, const long long last) {
+        BaccMCTruthEvent* theEvent = 0;
+        {
+            TChain theChain("MCTruthTree");
+            for (int i = 0; i < filePath.size(); i++)
+            {
+                theChain.Add(filePath[i].c_str());
+            }
+            theChain.SetBranchAddress("MCTruthEvent", &theEvent);
+            if (isSplit(&theChain, "MCTruthEvent"))
+            {
+                theChain.SetBranchStatus("*", false);
+                for (const char* member : kScanMembers)
+                    theChain.SetBranchStatus((std::string("*") + member).c_str(), true);
+            }
+
+            for (long long i = first; i < last; ++i)
+            {
+                theChain.GetEntry(i);
+                theIndex.firstPhotonTime[i] = theEvent->fEventFirstPhotonTime_ns;
+                theIndex.lastPhotonTime[i] = theEvent->fEventLastPhotonTime_ns;
+                theIndex.parentTime[i] = theEvent->fParentTime_ns;
+                theIndex.referenceTime[i] = theEvent->fReferencePhotonTime_ns;
+                for (int j = 0; j < theEvent->iPMTHits.size(); j++)
+                {
+                    if (theEvent->iPMTHits[j] != 0)
+                        theHits[i].push_back(std::make_pair(j, (int)theEvent->iPMTHits[j]));
+                }
+                nChannels[worker] = std::max(nChannels[worker], (unsigned int)theEvent->iPMTHits.size());
+            }
+        }
+        delete theEvent;
+    };
+
+    std::vector<std::thread> theWorkers;
+    for (unsigned int w = 1; w < nWorkers; ++w)
+        theWorkers.push_back(std::thread(scanRange, w, N * w / nWorkers, N * (w + 1) / nWorkers));
+    scanRange(0, 0, N / nWorkers);
+    for (auto& theWorker : theWorkers)
+        theWorker.join();
+
+    theIndex.nChannels = *std::max_element(nChannels.begin(), nChannels.end());
+    theIndex.hitsBegin.assign(1, 0);
+    theIndex.hitPMT.clear();
+    theIndex.hitPhotons.clear();
+    for (long long i = 0; i < N; i++)
+    {
+        for (const auto& theHit : theHits[i])
+        {
+            theIndex.hitPMT.push_back(theHit.first);
+            theIndex.hitPhotons.push_back(theHit.second);
+        }
+        theIndex.hitsBegin.push_back(theIndex.hitPMT.size());
+    }
 }
 
+unsigned long long RootInputMDC2::getInputChecksum() const
+{
+    /**
+     * Checksum of the input files that keys the event index: FNV-1a over
+     * the modification time, the size and the first and last MiB of each
+     * file, in order. A ROOT file keeps its header at the start and its keys
+     * at the end, so a rewritten file changes the checksum without the whole
+     * file being read, even if it is rewritten within the same second.
+     * Returns 0 if a file cannot be read locally, e.g. over XRootD.
+     */
+    std::uint64_t hash = 14695981039346656037ULL;
+    std::vector<char> theBlock(kChecksumBlock);
+    for (int i = 0; i < filePath.size(); i++)
+    {
+        struct stat theStat;
+        if (stat(filePath[i].c_str(), &theStat) != 0)
+            return 0;
+        std::int64_t mtime = theStat.st_mtime;
+        fnv1a(hash, (const char*)&mtime, sizeof(mtime));
+
+        std::ifstream theFile(filePath[i], std::ios::binary | std::ios::ate);
+        if (!theFile)
+            return 0;
+        std::streamoff size = theFile.tellg();
+        fnv1a(hash, (const char*)&size, sizeof(size));
+
+        std::streamoff n = std::min(size, kChecksumBlock);
+        theFile.seekg(0);
+        theFile.read(theBlock.data(), n);
+        fnv1a(hash, theBlock.data(), n);
+        theFile.seekg(size - n);
+        theFile.read(theBlock.data(), n);
+        fnv1a(hash, theBlock.data(), n);
+        if (!theFile)
+            return 0;
+    }
+    return (hash != 0 ? hash : 1);
+}
+
+std::string RootInputMDC2::getEventIndexPath() const
+{
+    /**
+     * Path of the event index file given by EventIndexFile: in outDir,
+     * named after the first input file, if auto, none if it is not kept.
+     * The input directory is left alone, as it may be read-only or shared.
+     */
+    std::string thePath = global::get_optional_config("EventIndexFile", "none");
+    if (thePath == "none" || filePath.empty())
+        return "";
+    if (thePath == "auto")
+    {
+        std::string outDirectory = global::config->getConfig("outDir");
+        if (!outDirectory.empty() && outDirectory.back() != '/')
+            outDirectory.append("/");
+        return outDirectory + filePath[0].substr(filePath[0].find_last_of('/') + 1) + ".deridx";
+    }
+    return thePath;
+}
+
+bool RootInputMDC2::readEventIndex(const std::string& path, const unsigned long long& checksum, EventIndex& theIndex) const
+{
+    /**
+     * Read the sidecar event index at path. Returns false if there is none,
+     * or if it is of another version or of other input files.
+     */
+    std::ifstream theFile(path, std::ios::binary);
+    if (!theFile)
+        return false;
+
+    char magic[sizeof(kEventIndexMagic)];
+    std::uint32_t version = 0;
+    std::uint64_t theChecksum = 0;
+    std::uint32_t nChannels = 0;
+    theFile.read(magic, sizeof(magic));
+    theFile.read((char*)&version, sizeof(version));
+    theFile.read((char*)&theChecksum, sizeof(theChecksum));
+    theFile.read((char*)&nChannels, sizeof(nChannels));
+    if (!theFile || std::memcmp(magic, kEventIndexMagic, sizeof(magic)) != 0 || version != kEventIndexVersion
+        || theChecksum != checksum)
+        return false;
+
+    theIndex.nChannels = nChannels;
+    if (!readBlock(theFile, theIndex.firstPhotonTime) || !readBlock(theFile, theIndex.lastPhotonTime)
+        || !readBlock(theFile, theIndex.parentTime) || !readBlock(theFile, theIndex.referenceTime)
+        || !readBlock(theFile, theIndex.hitsBegin)
+        || !readBlock(theFile, theIndex.hitPMT) || !readBlock(theFile, theIndex.hitPhotons))
+        return false;
+
+    size_t N = theIndex.firstPhotonTime.size();
+    return theIndex.lastPhotonTime.size() == N && theIndex.parentTime.size() == N && theIndex.referenceTime.size() == N
+        && theIndex.hitsBegin.size() == N + 1 && theIndex.hitsBegin.back() == theIndex.hitPMT.size()
+        && theIndex.hitPhotons.size() == theIndex.hitPMT.size();
+}
+
+bool RootInputMDC2::writeEventIndex(const std::string& path, const unsigned long long& checksum, const EventIndex& theIndex) const
+{
+    /**
+     * Write the sidecar event index to path. It is written to a temporary
+     * file that is renamed, so a run that is stopped never leaves a partial
+     * index behind. Returns false if it cannot be written.
+     */
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream theFile(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!theFile)
+            return false;
+
+        std::uint32_t version = kEventIndexVersion;
+        std::uint64_t theChecksum = checksum;
+        std::uint32_t nChannels = theIndex.nChannels;
+        theFile.write(kEventIndexMagic, sizeof(kEventIndexMagic));
+        theFile.write((const char*)&version, sizeof(version));
+        theFile.write((const char*)&theChecksum, sizeof(theChecksum));
+        theFile.write((const char*)&nChannels, sizeof(nChannels));
+        writeBlock(theFile, theIndex.firstPhotonTime);
+        writeBlock(theFile, theIndex.lastPhotonTime);
+        writeBlock(theFile, theIndex.parentTime);
+        writeBlock(theFile, theIndex.referenceTime);
+        writeBlock(theFile, theIndex.hitsBegin);
+        writeBlock(theFile, theIndex.hitPMT);
+        writeBlock(theFile, theIndex.hitPhotons);
+        if (!theFile.flush())
+        {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+#endif
+
 int RootInputMDC2::makePMTDataReady()
 {
     /**
      * Returns -1 if error, 0 if ok.
+     *
+     * The hit PMTs and photon times of the events come from an event index
+     * of this process or of EventIndexFile if it matches the input files,
+     * else from a parallel scan, after which the index is kept for the next
+     * runs. The dark counts and the cuts depend on the settings, so they are
+     * applied here on every run.
+     *
+     * Events whose photons span more than the simulated window get a photon
+     * time cut, so that the photons after the window are not read. The cut
+     * is PhotonWindowMargin [ns] after the window and is taken from the
+     * earlier of the parent and reference times, so it never removes a
+     * photon that getPMTData() would keep.
      */
 #if (BACC_LIB_VERSION == 6)
     std::cout << "Preparing input file..." << std::endl;
     long long N = data->GetEntries();
     data->SetBranchAddress("MCTruthEvent", &BaccObj);
-    std::vector<int> startIdx(BaccObj->iPMTHits.size(), 0);
     nDataEntries.resize(N);
     EventAndPMTInfos.resize(N);
     AllEventFirstPhotonTimes_ns.resize(N);
     fPreEventWindow = std::stoull(global::config->getConfig("PreEventWindow"));
     fPostEventWindow = std::stoull(global::config->getConfig("PostEventWindow"));
+    fPMTStreamCacheSize = std::stoll(global::get_optional_config("PMTStreamCacheSize", "262144"));
+    std::string margin = global::get_optional_config("PhotonWindowMargin", "1000");
+    bool doPushDown = (margin != "none");
+    double windowMargin = (doPushDown ? std::stod(margin) : 0); //[ns]
+    unsigned int nThreads = std::stoul(global::get_optional_config("InputScanThreads", "0"));
+    if (nThreads == 0)
+        nThreads = std::stoi(global::config->getConfig("NCores")) * std::stoi(global::config->getConfig("Thread"));
 
+    EventIndex theIndex;
+    std::string indexPath = getEventIndexPath();
+    std::string inputKey;
+    for (int i = 0; i < filePath.size(); i++)
+        inputKey += filePath[i] + "\n";
+    unsigned long long checksum = getInputChecksum();
+    bool keepFile = (checksum != 0 && !indexPath.empty());
+    auto resident = fResidentIndexes.find(inputKey);
+    if (checksum != 0 && resident != fResidentIndexes.end() && resident->second.first == checksum
+        && resident->second.second.firstPhotonTime.size() == N)
+    {
+        theIndex = resident->second.second;
+        std::cout << "Using resident event index of the input" << std::endl;
+    }
+    else if (keepFile && readEventIndex(indexPath, checksum, theIndex) && theIndex.firstPhotonTime.size() == N)
+    {
+        std::cout << "Read event index " << indexPath << std::endl;
+    }
+    else
+    {
+        scanEvents(theIndex, nThreads);
+        if (keepFile && !writeEventIndex(indexPath, checksum, theIndex))
+            std::cout << "NOTICE: Cannot write event index " << indexPath << std::endl;
+    }
+    if (checksum != 0)
+    { // kept for the next runs in this process
+        if (fResidentIndexes.size() >= kMaxResidentIndexes && !fResidentIndexes.count(inputKey))
+            fResidentIndexes.clear();
+        fResidentIndexes[inputKey] = std::make_pair(checksum, theIndex);
+    }
+
+    enableParallelUnzip(std::stoul(global::get_optional_config("InputUnzipThreads", "0")));
+
+    fNChannels = theIndex.nChannels;
+    fPhotonTimeCut.assign(N, std::numeric_limits<double>::max());
+    unsigned long long nCutEvents = 0;
+    std::vector<int> startIdx(theIndex.nChannels, 0);
     for (int i = 0; i < N; i++)
     {
-        data->GetEvent(i);
         int nPMTs = 0;
-        AllEventFirstPhotonTimes_ns[i] = (BaccObj->fEventFirstPhotonTime_ns + BaccObj->fParentTime_ns - fPreEventWindow);
-        unsigned long long Length = (unsigned long long) BaccObj->fEventLastPhotonTime_ns - (unsigned long long) BaccObj->fEventFirstPhotonTime_ns 
+        double firstPhotonTime = theIndex.firstPhotonTime[i];
+        double lastPhotonTime = theIndex.lastPhotonTime[i];
+        AllEventFirstPhotonTimes_ns[i] = (firstPhotonTime + theIndex.parentTime[i] - fPreEventWindow);
+        unsigned long long Length = (unsigned long long) lastPhotonTime - (unsigned long long) firstPhotonTime
                                     + fPreEventWindow + fPostEventWindow;
         if(Length > (unsigned long long)PostTriggerWindow) Length = (unsigned long long)PostTriggerWindow;
-        for (int j = 0; j < BaccObj->iPMTHits.size(); j++)
+        if (doPushDown && lastPhotonTime - firstPhotonTime + fPreEventWindow > PostTriggerWindow + windowMargin)
+        {
+            fPhotonTimeCut[i] = PostTriggerWindow + windowMargin + firstPhotonTime - fPreEventWindow
+                - std::min(theIndex.parentTime[i], theIndex.referenceTime[i]);
+            ++nCutEvents;
+        }
+        unsigned long long hit = theIndex.hitsBegin[i];
+        for (int j = 0; j < theIndex.nChannels; j++)
         {
+            int nHits = 0;
+            if (hit < theIndex.hitsBegin[i + 1] && theIndex.hitPMT[hit] == j)
+                nHits = theIndex.hitPhotons[hit++];
             int darkCountRate = PMT::getParamPointer()->getConfig("DarkCount",    j);
             int DarkCounts    = determineDarkCounts(Length, darkCountRate);
-            if(BaccObj->iPMTHits[j]!=0 || DarkCounts != 0) 
+            if(nHits!=0 || DarkCounts != 0) 
             {
                 ++nPMTs;
                 PMTStreamInfo info;
                 info.PMTnumber = j;
                 info.StartIdx = (int)startIdx[j];
-                info.NumberOfPhotons = (int)BaccObj->iPMTHits[j];
+                info.NumberOfPhotons = nHits;
                 info.NumberOfDarkCounts = DarkCounts; 
                 EventAndPMTInfos[i].push_back(info);
-                startIdx[j] += (BaccObj->iPMTHits[j]);
-                nDataEntries[i] += (BaccObj->iPMTHits[j]);
+                startIdx[j] += nHits;
+                nDataEntries[i] += nHits;
                 if (AvailablePMTs.size() == 0)
                 {
                     AvailablePMTs.push_back(j);
@@ -141,13 +717,12 @@ int RootInputMDC2::makePMTDataReady()
             }
         }
 
-        if (nPMTs == 0
-            || ((BaccObj->fEventLastPhotonTime_ns) - (BaccObj->fEventFirstPhotonTime_ns)) >= PhotonTimeLimit)
-        {
-            EmptyEvents.push_back(i);
-        }
-        AvailableEvents.push_back(i);
+        addAvailableEvent(i, nDataEntries[i], theIndex.hitsBegin[i + 1] - theIndex.hitsBegin[i],
+            lastPhotonTime - firstPhotonTime,
+            nPMTs == 0 || (lastPhotonTime - firstPhotonTime) >= PhotonTimeLimit);
     }
+    if (nCutEvents > 0)
+        std::cout << "NOTICE: Photons after the window are not read for " << nCutEvents << " events" << std::endl;
     SortData();
     makeEvtListFromSelection();
 
@@ -207,38 +782,29 @@ bool RootInputMDC2::getPMTData(const unsigned long long evt)
     std::vector<PMTData>().swap(PmtData);
     PmtData.reserve(nDataEntries[evt]);
 
-    TString treename = "PMTStream";
-    TString currenttreename;
     int pmtID = 0;
 
     for (int k = 0; k < NumberOfPMTs; k++)
     {
         //Find the TTree for the current pmt
-        pmtID = EventAndPMTInfos[evt][k].PMTnumber;
-        currenttreename = treename + std::to_string(pmtID);
-        TChain* pmttree = new TChain(currenttreename);
-        for (int i = 0; i < filePath.size(); i++)
-        {
-            pmttree->Add(filePath[i].c_str());
-        }
-        pmttree->SetBranchAddress("PhotonMCTruth", &pmthits);
+        const PMTStreamInfo& info = EventAndPMTInfos[evt][k];
+        pmtID = info.PMTnumber;
+        const PhotonPrefetcher::PhotonColumns& thePhotons = getEventPhotons(evt)[k];
 
-        for (int i = EventAndPMTInfos[evt][k].StartIdx; i < (EventAndPMTInfos[evt][k].StartIdx + EventAndPMTInfos[evt][k].NumberOfPhotons); i++)
+        for (size_t i = 0; i < thePhotons.time.size(); i++)
         {
-            pmttree->GetEntry(i);
-            if ((pmthits->fTime_ns - EventFirstPhotonTimeRelativeToParent_ns) > PostTriggerWindow)
+            if ((thePhotons.time[i] - EventFirstPhotonTimeRelativeToParent_ns) > PostTriggerWindow)
                 continue;
             PMTData newPmtData;
             newPmtData.id = pmtID;
-            newPmtData.time = (double)pmthits->fTime_ns - EventFirstPhotonTimeRelativeToParent_ns;
-            newPmtData.wavelength = (double)pmthits->fWavelength_nm;
+            newPmtData.time = thePhotons.time[i] - EventFirstPhotonTimeRelativeToParent_ns;
+            newPmtData.wavelength = thePhotons.wavelength[i];
             newPmtData.EventID = (int)evt; //to get actual BACCARAT event numer: BaccObj->iEventNumber;
             newPmtData.RunNumber = RunNumber;
-            newPmtData.InteractionIdentifier = pmthits->iInteractionIdentifier;
-            newPmtData.VertexNumber = pmthits->iVertexNumber;
+            newPmtData.InteractionIdentifier = thePhotons.interactionID[i];
+            newPmtData.VertexNumber = thePhotons.vertexNumber[i];
             PmtData.push_back(newPmtData);
         }
-        delete pmttree;
     }
 #endif
     return true;
@@ -264,41 +830,33 @@ bool RootInputMDC2::getPMTData(const unsigned long long evt,
     //First get event level information: RunNumber and EventFirstPhotonTime_ns
     int RunNumber = BaccObj->iRunNumber;
     double EventFirstPhotonTimeRelativeToReferenceTime_ns = (BaccObj->fEventFirstPhotonTime_ns - fPreEventWindow - BaccObj->fReferencePhotonTime_ns);
-    int pmtNumber = EventAndPMTInfos[(int)evt][idx].PMTnumber;
+    const PMTStreamInfo& info = EventAndPMTInfos[(int)evt][idx];
+    int pmtNumber = info.PMTnumber;
     thePMT->setPMTNumber(pmtNumber);
     thePMT->resetPMTVectors();
 
-    TString treeName = "PMTStream" + std::to_string(pmtNumber);
-    TChain* pmtTree = new TChain(treeName);
-    for (int i = 0; i < filePath.size(); i++)
-    {
-        pmtTree->Add(filePath[i].c_str());
-    }
-    pmtTree->SetBranchAddress("PhotonMCTruth", &pmthits);
+    // The photons of the event are one entry range of the PMT's chain.
+    const PhotonPrefetcher::PhotonColumns& thePhotons = getEventPhotons(evt)[idx];
 
-    for (int i = EventAndPMTInfos[(int)evt][idx].StartIdx;
-         i < (EventAndPMTInfos[(int)evt][idx].StartIdx + EventAndPMTInfos[(int)evt][idx].NumberOfPhotons);
-         i++)
+    for (size_t i = 0; i < thePhotons.time.size(); i++)
     {
-        pmtTree->GetEntry(i);
-	double photonTime = (double)pmthits->fTime_ns - EventFirstPhotonTimeRelativeToReferenceTime_ns;
+	double photonTime = thePhotons.time[i] - EventFirstPhotonTimeRelativeToReferenceTime_ns;
         if (photonTime > PostTriggerWindow)
 	  continue;
         if (photonTime < 0)
 	  photonTime = 0;
 	std::shared_ptr<PMT::TimesAndPheResp> thePhoton = std::make_shared<PMT::TimesAndPheResp>();
-        thePhoton->wavelength = pmthits->fWavelength_nm;
+        thePhoton->wavelength = thePhotons.wavelength[i];
 	thePhoton->idx = (unsigned long long)photonTime + timeShift + TimeShiftInc * k; //Not cntr?
         thePhoton->cathodeTime = (unsigned long long)photonTime + timeShift + TimeShiftInc * k;
         thePhoton->isDER = false;
 	thePhoton->BaccEvtNum = (int)evt;
-        thePhoton->interactionID = pmthits->iInteractionIdentifier;
-        thePhoton->vertexNum = pmthits->iVertexNumber;
-        thePhoton->pulseID = pmthits->iPulseID;
+        thePhoton->interactionID = thePhotons.interactionID[i];
+        thePhoton->vertexNum = thePhotons.vertexNumber[i];
+        thePhoton->pulseID = thePhotons.pulseID[i];
 	thePMT->assignPhotonToList(thePhoton, eventLength);
     }
-    thePMT->generateDarkCounts(evt, EventAndPMTInfos[(int)evt][idx].NumberOfDarkCounts, eventLength);
-    delete pmtTree;
+    thePMT->generateDarkCounts(evt, info.NumberOfDarkCounts, eventLength);
 #endif
     return true;
 }
@@ -355,13 +913,84 @@ double RootInputMDC2::getEventFirstPhotonTime(unsigned long long evt)
     return AllEventFirstPhotonTimes_ns[evt];
 }
 
-int RootInputMDC2::determineDarkCounts(const unsigned long length, double darkCountRate) {
+bool RootInputMDC2::writeFlatPhotons(const std::string& path)
+{
     /**
-     * Method to generate Dark counts
+     * Convert the input to a flat photon file at path, for FlatPhotonInput.
+     * Must be called after makePMTDataReady(). The dark counts are not
+     * written, as they are drawn on every run. Each section of the file is
+     * written in place as the events are read, so the photons of one PMT
+     * are held in memory at a time.
+     * Returns false if the file cannot be written.
      */
-    //Add dark counts from photocathode
-    unsigned long long seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::default_random_engine generator((unsigned int)seed);
-    std::poisson_distribution<int> distribution(darkCountRate*length/1e9);
-    return distribution(generator); 
+#if (BACC_LIB_VERSION == 6)
+    static_assert(sizeof(int) == sizeof(std::int32_t), "The flat photon format has 32 bit integer columns");
+    std::uint64_t nPMTs = 0;
+    std::uint64_t nPhotons = 0;
+    for (size_t i = 0; i < EventAndPMTInfos.size(); i++)
+    {
+        for (const PMTStreamInfo& info : EventAndPMTInfos[i])
+        {
+            if (info.NumberOfPhotons > 0)
+            {
+                ++nPMTs;
+                nPhotons += info.NumberOfPhotons;
+            }
+        }
+    }
+    std::string userName = getUserName();
+    FlatPhotonInput::Header theHeader
+        = FlatPhotonInput::makeHeader(fNChannels, EventAndPMTInfos.size(), nPMTs, nPhotons, userName.size());
+
+    std::ofstream theFile(path, std::ios::binary | std::ios::trunc);
+    if (!theFile)
+        return false;
+    auto writeAt = [&theFile](const std::uint64_t& offset, const void* theValues, const size_t& size) {
+        theFile.seekp(offset);
+        theFile.write((const char*)theValues, size);
+    };
+    writeAt(0, &theHeader, sizeof(theHeader));
+
+    PhotonPrefetcher::PhotonColumns thePhotons;
+    std::uint64_t pmtIdx = 0;
+    std::uint64_t photonIdx = 0;
+    for (size_t i = 0; i < EventAndPMTInfos.size(); i++)
+    {
+        data->GetEntry(i);
+        FlatPhotonInput::EventEntry theEvent = FlatPhotonInput::EventEntry();
+        theEvent.firstPhotonTime = BaccObj->fEventFirstPhotonTime_ns;
+        theEvent.lastPhotonTime = BaccObj->fEventLastPhotonTime_ns;
+        theEvent.parentTime = BaccObj->fParentTime_ns;
+        theEvent.referencePhotonTime = BaccObj->fReferencePhotonTime_ns;
+        theEvent.runNumber = BaccObj->iRunNumber;
+        theEvent.nVertices = BaccObj->vertices.size();
+        theEvent.firstPMT = pmtIdx;
+
+        for (const PMTStreamInfo& info : EventAndPMTInfos[i])
+        {
+            if (info.NumberOfPhotons == 0)
+                continue;
+            readPhotons(info, std::numeric_limits<double>::max(), thePhotons);
+            FlatPhotonInput::PMTEntry thePMT = FlatPhotonInput::PMTEntry();
+            thePMT.pmt = info.PMTnumber;
+            thePMT.nPhotons = info.NumberOfPhotons;
+            thePMT.firstPhoton = photonIdx;
+            writeAt(theHeader.pmtsOffset + pmtIdx * sizeof(thePMT), &thePMT, sizeof(thePMT));
+
+            size_t n = thePhotons.time.size();
+            writeAt(theHeader.timeOffset + photonIdx * sizeof(double), thePhotons.time.data(), n * sizeof(double));
+            writeAt(theHeader.wavelengthOffset + photonIdx * sizeof(double), thePhotons.wavelength.data(), n * sizeof(double));
+            writeAt(theHeader.interactionIDOffset + photonIdx * sizeof(std::int32_t), thePhotons.interactionID.data(), n * sizeof(std::int32_t));
+            writeAt(theHeader.vertexNumberOffset + photonIdx * sizeof(std::int32_t), thePhotons.vertexNumber.data(), n * sizeof(std::int32_t));
+            writeAt(theHeader.pulseIDOffset + photonIdx * sizeof(std::int32_t), thePhotons.pulseID.data(), n * sizeof(std::int32_t));
+            photonIdx += n;
+            ++pmtIdx;
+            ++theEvent.nPMTs;
+        }
+        writeAt(theHeader.eventsOffset + i * sizeof(theEvent), &theEvent, sizeof(theEvent));
+    }
+    writeAt(theHeader.userNameOffset, userName.data(), userName.size());
+    return (bool)theFile.flush();
+#endif
+    return false;
 }
@@ -480,27 +480,28 @@ void RootOutputMDC1::doWriteDERMCTruth(std::shared_ptr<MCTruth> theTruth)
         for (int j = 0; j < theTruth->getTruthSize(); j++)
         {
             //Only keep information for photons which made it into a POD.
-            if (theTruth->getMCTruthDataObject(j)->DEREvt)
+            const MCTruth::MCTruthData theData = theTruth->getMCTruthData(j);
+            if (theData.DEREvt)
             {
                 //Determine iOrigin type: Combination of InteractionIdentifier and pheType
                 //First digit gives information about pheType:
                 //1 SPHE, 2 DPHE, 3 firstDynHits, 4 SecDynColl, 5 DarkCount, 6 AftPulse
                 //Second digit gives information abour InteractionIdentifier:
                 //1 S1, 2 S2, 3 Cherenkov, 4 Scintillation, 5 Other.
-                Origin = (unsigned char)(10 * (theTruth->getMCTruthDataObject(j)->pheType) + (theTruth->getMCTruthDataObject(j)->InteractionIdentifier));
+                Origin = (unsigned char)(10 * (theData.pheType) + (theData.InteractionIdentifier));
 
                 //per event variables
-                DERevt = theTruth->getMCTruthDataObject(j)->DEREvt;
-                SimEvt = theTruth->getMCTruthDataObject(j)->SimEvt;
-                RunNum = theTruth->getMCTruthDataObject(j)->SimRunNumber;
+                DERevt = theData.DEREvt;
+                SimEvt = theData.SimEvt;
+                RunNum = theData.SimRunNumber;
 
                 //Store MCTruth information in buffer
                 PhotonInfo ph;
                 ph.Origin = Origin;
-                ph.DERArrivalTime = theTruth->getMCTruthDataObject(j)->ArrivalTime;
-                ph.HGPODIdx = theTruth->getMCTruthDataObject(j)->HGPODIdx;
-                ph.LGPODIdx = theTruth->getMCTruthDataObject(j)->LGPODIdx;
-                ph.BaccVertexIdx = theTruth->getMCTruthDataObject(j)->VertexNumber;
+                ph.DERArrivalTime = theData.ArrivalTime;
+                ph.HGPODIdx = theData.HGPODIdx;
+                ph.LGPODIdx = theData.LGPODIdx;
+                ph.BaccVertexIdx = theData.VertexNumber;
 
                 AllPhotons[prevSize + counter] = ph;
 
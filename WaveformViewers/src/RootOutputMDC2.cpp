@@ -21,7 +21,9 @@ RootOutputMDC2::RootOutputMDC2()
 #if (BACC_LIB_VERSION == 6)
     TruthObj = 0;
     BaccObj = 0;
+    FlatInput = 0;
 #endif
+    SimEvt = 0;
 }
 
 RootOutputMDC2::~RootOutputMDC2()
@@ -59,6 +61,35 @@ void RootOutputMDC2::doWriteData(POD& theEBDataPOD, const int& DCID)
 #endif
 }
 
+void RootOutputMDC2::doWriteData(const PODArena& thePODs)
+{
+    /**
+     * Write all PODs of thePODs to disk, filling the branches straight from
+     * the arena.
+     */
+#if (BACC_LIB_VERSION == 6)
+    for (size_t i = 0; i < thePODs.size(); ++i)
+    {
+        const PODArena::Descriptor& thePOD = thePODs.at(i);
+        evt = thePOD.event - 1; //Subtract 1 to start at 0
+        LUXSimRunNumber = thePOD.luxSimRunNumber;
+        channel = thePOD.channel;
+        hit = thePOD.hitID;
+        startTime = thePOD.start + trgTimeStamp;
+        nSamples = thePOD.length;
+
+        sumPODlength += nSamples;
+        ++nPODInFile;
+        if (startTime < sumPODstartTS)
+            sumPODstartTS = startTime;
+
+        const short* samples = thePODs.getSamples(thePOD);
+        zData.assign(samples, samples + thePOD.length);
+        fData->Fill();
+    }
+#endif
+}
+
 void RootOutputMDC2::doWriteGlobal(EBGlobal* theGlobalSummary)
 {
     /**
@@ -423,6 +454,21 @@ void RootOutputMDC2::doInitInputVariables(Input* input)
         std::cout << "ERROR: Pointer to TChain is NULL" << std::endl;
 
     RootInputMDC2* temp = dynamic_cast<RootInputMDC2*>(input);
+    if (temp == NULL)
+    {
+        // e.g. a flat photon file, which has no BACCARAT event objects
+        BaccObj = 0;
+        FlatInput = dynamic_cast<FlatPhotonInput*>(input);
+        if (FlatInput)
+            std::cout << "NOTICE: The flat photon input keeps the run number and parent time of each "
+                      << "BACCARAT event only, the MCTruth is written without the other event and "
+                      << "the vertex information" << std::endl;
+        else
+            std::cout << "NOTICE: The input has no BaccMCTruthEvent, "
+                      << "the MCTruth is written without BACCARAT event and vertex information" << std::endl;
+        return;
+    }
+    FlatInput = 0;
     temp->getBaccObj(BaccObj);
     if (input == NULL || input == 0 || BaccObj == NULL || BaccObj == 0)
     {
@@ -470,8 +516,9 @@ void RootOutputMDC2::doWriteDetectorMCTruthEvent()
         std::vector<short int> newVertexNum(VertexCount.size(), -1);
         std::vector<unsigned int> VertexIdx;
         VertexIdx.reserve(VertexCount.size());
+        bool haveBaccEvent = (BaccObj != 0 && *BaccObj != 0);
         //starting at 1, as not interested in -1.
-        for (int i = 1; i < VertexCount.size(); i++)
+        for (int i = 1; i < VertexCount.size() && haveBaccEvent; i++)
         {
             if (VertexCount[i] != 0)
             {
@@ -562,14 +609,23 @@ void RootOutputMDC2::doWriteDetectorMCTruthEvent()
         //Filling of per event information.
         //Each DER event corresponds to exactly one BACCARAT event.
         TruthObj->iDEREventNumber = (unsigned short)DERevt - 1; //subtract 1 to match data tree.
-        TruthObj->iRunNumber = (*BaccObj)->iRunNumber;
-        TruthObj->iBaccEventNumber = (*BaccObj)->iEventNumber;
-        TruthObj->sParentParticleName = (*BaccObj)->sParentParticleName;
-        TruthObj->sParentVolumeName = (*BaccObj)->sParentVolumeName;
-        TruthObj->fParentPosition_mm = (*BaccObj)->fParentPosition_mm;
-        TruthObj->fParentEnergy_keV = (*BaccObj)->fParentEnergy_keV;
-        TruthObj->fParentDirection = (*BaccObj)->fParentDirection;
-        TruthObj->fParentTime_ns = (*BaccObj)->fParentTime_ns;
+        if (haveBaccEvent)
+        {
+            TruthObj->iRunNumber = (*BaccObj)->iRunNumber;
+            TruthObj->iBaccEventNumber = (*BaccObj)->iEventNumber;
+            TruthObj->sParentParticleName = (*BaccObj)->sParentParticleName;
+            TruthObj->sParentVolumeName = (*BaccObj)->sParentVolumeName;
+            TruthObj->fParentPosition_mm = (*BaccObj)->fParentPosition_mm;
+            TruthObj->fParentEnergy_keV = (*BaccObj)->fParentEnergy_keV;
+            TruthObj->fParentDirection = (*BaccObj)->fParentDirection;
+            TruthObj->fParentTime_ns = (*BaccObj)->fParentTime_ns;
+        }
+        else if (FlatInput)
+        {
+            const FlatPhotonInput::EventEntry& theEvent = FlatInput->getEventEntry(SimEvt);
+            TruthObj->iRunNumber = theEvent.runNumber;
+            TruthObj->fParentTime_ns = theEvent.parentTime;
+        }
 
         //Iterate over BaccVertices vector to fill DetectorVertexMCTruth
         TruthObj->vertices.resize(VertexCounter);
@@ -707,10 +763,11 @@ void RootOutputMDC2::doWriteDERMCTruth(std::shared_ptr<MCTruth> theTruth)
         //Check what the maximum PulseID is.
         for (int i = 0; i < theTruth->getTruthSize(); i++)
         {
-            if (theTruth->getMCTruthDataObject(i)->DEREvt)
+            const MCTruth::MCTruthData theData = theTruth->getMCTruthData(i);
+            if (theData.DEREvt)
             {
-                if (theTruth->getMCTruthDataObject(i)->PulseID >= maxPulseID)
-                    maxPulseID = (theTruth->getMCTruthDataObject(i)->PulseID + 1);
+                if (theData.PulseID >= maxPulseID)
+                    maxPulseID = (theData.PulseID + 1);
             }
         }
         //Resize AllPulses and AftPulses vector to be able to accomodate all pulses
@@ -745,17 +802,19 @@ void RootOutputMDC2::doWriteDERMCTruth(std::shared_ptr<MCTruth> theTruth)
         for (int i = 0; i < theTruth->getTruthSize(); i++)
         {
             //Only want to keep the information of photons which made it into a POD.
-            if (theTruth->getMCTruthDataObject(i)->DEREvt)
+            const MCTruth::MCTruthData theData = theTruth->getMCTruthData(i);
+            if (theData.DEREvt)
             {
-                DERevt = theTruth->getMCTruthDataObject(i)->DEREvt;
-                ++VertexCount[theTruth->getMCTruthDataObject(i)->VertexNumber + 1];
+                DERevt = theData.DEREvt;
+                SimEvt = theData.SimEvt;
+                ++VertexCount[theData.VertexNumber + 1];
 
                 //Add dark counts to the darkpulses vector.
-                if (theTruth->getMCTruthDataObject(i)->pheType == 5)
+                if (theData.pheType == 5)
                 {
                     DarkCountInfo darkCount;
-                    darkCount.pmt = theTruth->getMCTruthDataObject(i)->PMTNumber;
-                    darkCount.time = theTruth->getMCTruthDataObject(i)->ArrivalTime;
+                    darkCount.pmt = theData.PMTNumber;
+                    darkCount.time = theData.ArrivalTime;
                     darkpulses[prevDarkCountSize + cntr] = darkCount;
                     ++cntr;
                 }
@@ -764,51 +823,51 @@ void RootOutputMDC2::doWriteDERMCTruth(std::shared_ptr<MCTruth> theTruth)
                 //the photon which initiated the afterpulse.
                 else
                 {
-                    pulseID = theTruth->getMCTruthDataObject(i)->PulseID;
+                    pulseID = theData.PulseID;
                     //PheType == 6 means it was an afterpulse, therefore the information is stored
                     //in AftpUlses
-                    if (theTruth->getMCTruthDataObject(i)->pheType == 6)
+                    if (theData.pheType == 6)
                     {
-                        AftPulses[pulseID].SimEvt = (unsigned int)theTruth->getMCTruthDataObject(i)->SimEvt;
-                        AftPulses[pulseID].PulseType = theTruth->getMCTruthDataObject(i)->InteractionIdentifier;
-                        AftPulses[pulseID].BaccVertexNumber = theTruth->getMCTruthDataObject(i)->VertexNumber;
+                        AftPulses[pulseID].SimEvt = (unsigned int)theData.SimEvt;
+                        AftPulses[pulseID].PulseType = theData.InteractionIdentifier;
+                        AftPulses[pulseID].BaccVertexNumber = theData.VertexNumber;
 
                         //Find the first and last time of the pulse.
-                        if (AftPulses[pulseID].FirstPheTime > theTruth->getMCTruthDataObject(i)->ArrivalTime)
+                        if (AftPulses[pulseID].FirstPheTime > theData.ArrivalTime)
                         {
-                            AftPulses[pulseID].FirstPheTime = theTruth->getMCTruthDataObject(i)->ArrivalTime;
+                            AftPulses[pulseID].FirstPheTime = theData.ArrivalTime;
                         }
-                        if (AftPulses[pulseID].LastPheTime < theTruth->getMCTruthDataObject(i)->ArrivalTime)
+                        if (AftPulses[pulseID].LastPheTime < theData.ArrivalTime)
                         {
-                            AftPulses[pulseID].LastPheTime = theTruth->getMCTruthDataObject(i)->ArrivalTime;
+                            AftPulses[pulseID].LastPheTime = theData.ArrivalTime;
                         }
 
                         //Increment count of phe for the PMT in question.
-                        AftPulses[pulseID].PmtsHit[(int)theTruth->getMCTruthDataObject(i)->PMTNumber] += 1;
+                        AftPulses[pulseID].PmtsHit[(int)theData.PMTNumber] += 1;
                         AftPulses[pulseID].PheCount += 1;
                     }
                     //All other photon information goes into the pulses in AllPulses.
                     else
                     {
-                        AllPulses[pulseID].SimEvt = (unsigned int)theTruth->getMCTruthDataObject(i)->SimEvt;
-                        AllPulses[pulseID].PulseType = theTruth->getMCTruthDataObject(i)->InteractionIdentifier;
-                        AllPulses[pulseID].BaccVertexNumber = theTruth->getMCTruthDataObject(i)->VertexNumber;
+                        AllPulses[pulseID].SimEvt = (unsigned int)theData.SimEvt;
+                        AllPulses[pulseID].PulseType = theData.InteractionIdentifier;
+                        AllPulses[pulseID].BaccVertexNumber = theData.VertexNumber;
 
                         //Find the first and last time of the pulse.
-                        if (AllPulses[pulseID].FirstPheTime > theTruth->getMCTruthDataObject(i)->ArrivalTime)
+                        if (AllPulses[pulseID].FirstPheTime > theData.ArrivalTime)
                         {
-                            AllPulses[pulseID].FirstPheTime = theTruth->getMCTruthDataObject(i)->ArrivalTime;
+                            AllPulses[pulseID].FirstPheTime = theData.ArrivalTime;
                         }
-                        if (AllPulses[pulseID].LastPheTime < theTruth->getMCTruthDataObject(i)->ArrivalTime)
+                        if (AllPulses[pulseID].LastPheTime < theData.ArrivalTime)
                         {
-                            AllPulses[pulseID].LastPheTime = theTruth->getMCTruthDataObject(i)->ArrivalTime;
+                            AllPulses[pulseID].LastPheTime = theData.ArrivalTime;
                         }
 
                         //Increment count of phe for the PMT in question.
-                        AllPulses[pulseID].PmtsHit[(int)theTruth->getMCTruthDataObject(i)->PMTNumber] += 1;
+                        AllPulses[pulseID].PmtsHit[(int)theData.PMTNumber] += 1;
                         AllPulses[pulseID].PheCount += 1;
                         //If double phe add additional count
-                        if (theTruth->getMCTruthDataObject(i)->pheType == 2)
+                        if (theData.pheType == 2)
                             AllPulses[pulseID].PheCount += 1;
                     }
                 }
@@ -943,7 +1002,7 @@ void RootOutputMDC2::doWriteRawData(Pulse& theLGPulse, Pulse& theHGPulse,
   podLGEnds.clear();
 
   std::vector<Double_t>* doubleHGData = &rawHGData;
-  (*doubleHGData)= theHGPulse.getSamples();
+  (*doubleHGData).assign(theHGPulse.begin(), theHGPulse.end());
 
   std::vector<Int_t>* photonHGStartData = &photonHGStarts;
   std::vector<Int_t>* photonHGEndData = &photonHGEnds;
@@ -966,7 +1025,7 @@ void RootOutputMDC2::doWriteRawData(Pulse& theLGPulse, Pulse& theHGPulse,
   //-------------------------------------------------------------------------
 
   std::vector<Double_t>* doubleLGData = &rawLGData;
-  (*doubleLGData)= theLGPulse.getSamples();
+  (*doubleLGData).assign(theLGPulse.begin(), theLGPulse.end());
 
   std::vector<Int_t>* photonLGStartData = &photonLGStarts;
   std::vector<Int_t>* photonLGEndData = &photonLGEnds;
@@ -41,6 +41,7 @@ namespace RunControl
 {
 
 void parse_user_inputs(int argc, char** argv, std::vector<std::string>& input_files, std::string& inFilename,
+    std::string& flatOutput, std::string& batchList, std::string& serveSocket,
     std::shared_ptr<DBInterface<std::string> > config)
 {
 
@@ -85,6 +86,33 @@ void parse_user_inputs(int argc, char** argv, std::vector<std::string>& input_fi
             std::cout << "Setting DERCONFIG path to " << path << std::endl;
             DERCONFIGPATHOverride = true;
         }
+        if (CurrArg == "--ConvertToFlat")
+        {
+            if (i + 1 < argc)
+                flatOutput = argv[i + 1];
+            else
+            {
+                throw std::runtime_error("Invalid input format, exiting...");
+            }
+        }
+        if (CurrArg == "--BatchList")
+        {
+            if (i + 1 < argc)
+                batchList = argv[i + 1];
+            else
+            {
+                throw std::runtime_error("Invalid input format, exiting...");
+            }
+        }
+        if (CurrArg == "--Serve")
+        {
+            if (i + 1 < argc)
+                serveSocket = argv[i + 1];
+            else
+            {
+                throw std::runtime_error("Invalid input format, exiting...");
+            }
+        }
     }
 
     config->setConfig(path.c_str()); // Directory of config file
@@ -105,7 +133,7 @@ void parse_user_inputs(int argc, char** argv, std::vector<std::string>& input_fi
         std::string currSID = argv[i];
         currSID.erase(0, 2);
 
-        if (currSID == "DERCONFIGPath")
+        if (currSID == "DERCONFIGPath" || currSID == "ConvertToFlat" || currSID == "BatchList" || currSID == "Serve")
         {
             continue;
         }
@@ -126,6 +154,20 @@ void parse_user_inputs(int argc, char** argv, std::vector<std::string>& input_fi
         }
     }
 
+    if (!batchList.empty() || !serveSocket.empty())
+    {
+        // The input files are given by the batch list or the service jobs
+        if (!batchList.empty() && !serveSocket.empty())
+        {
+            throw std::runtime_error("RunControl: --BatchList cannot be used with --Serve");
+        }
+        if (!flatOutput.empty())
+        {
+            throw std::runtime_error("RunControl: --ConvertToFlat cannot be used with --BatchList or --Serve");
+        }
+        return;
+    }
+
     if (!sourceFound)
     {
         inFilename = argv[argc - 1];
@@ -375,6 +417,154 @@ void setup_input(Input*& input, std::vector<std::string>& input_files)
     input->SelectDetectors();
 }
 
+format::revision get_input_format(const std::vector<std::string>& input_files)
+{
+    // Flat photon files are recognised by their extension, anything else is
+    // taken to be a BaccRootConverter file.
+    const std::string extension = ".derflat";
+    const std::string& inputFile = input_files.back();
+    if (inputFile.size() >= extension.size()
+        && inputFile.compare(inputFile.size() - extension.size(), extension.size(), extension) == 0)
+        return format::revision::FLATv1;
+    return format::revision::ROOTvMDC2;
+}
+
+void convert_to_flat_photons(Input* input, const std::string& path)
+{
+    RootInputMDC2* theInput = dynamic_cast<RootInputMDC2*>(input);
+    if (theInput == NULL)
+    {
+        throw std::runtime_error("RunControl: Only BaccRootConverter files can be converted to flat photon files");
+    }
+    std::cout << "Writing flat photon file " << path << std::endl;
+    if (!theInput->writeFlatPhotons(path))
+    {
+        throw std::runtime_error("RunControl: Unable to write flat photon file " + path);
+    }
+    std::cout << "Done" << std::endl;
+}
+
+std::vector<BatchJob> read_batch_list(const std::string& path)
+{
+    // One job per line: the input file and optionally the output directory,
+    // separated by white space. Empty lines and lines starting with # are
+    // skipped.
+    std::ifstream theList(path);
+    if (!theList)
+    {
+        throw std::runtime_error("RunControl: Unable to open batch list " + path);
+    }
+
+    std::vector<BatchJob> theJobs;
+    std::string line;
+    unsigned long lineNumber = 0;
+    while (std::getline(theList, line))
+    {
+        ++lineNumber;
+        std::istringstream theLine(line);
+        std::string inputFile;
+        if (!(theLine >> inputFile) || inputFile[0] == '#')
+            continue;
+
+        BatchJob theJob;
+        theJob.input_files.push_back(inputFile);
+        theLine >> theJob.outDir;
+        std::string extra;
+        if (theLine >> extra)
+        {
+            std::stringstream err_msg{ "" };
+            err_msg << "RunControl: Line " << lineNumber << " of batch list " << path
+                    << " has more than an input file and an output directory" << std::endl;
+            throw std::runtime_error(err_msg.str());
+        }
+        theJobs.push_back(theJob);
+    }
+
+    if (theJobs.empty())
+    {
+        throw std::runtime_error("RunControl: Batch list " + path + " contains no input files");
+    }
+    return theJobs;
+}
+
+std::string run_input_files(std::vector<std::string>& input_files, const std::string& derRandomSeed,
+    DeviceVectors& electronics, unsigned int firstDoubleGainStage, TStopwatch& timer, global::ConfigPtr config)
+{
+    // Everything that depends on the input files: the input, the output
+    // file, its summaries and the data collectors. The configuration, PMT
+    // parameters and electronics are set up by the caller and may be shared
+    // by many calls. Returns the name of the output file.
+    DERSummary dersummary;
+    EBSummary ebsummary;
+    EBGlobal ebGlobal;
+
+    DERSummary* theDERSummary = &dersummary;
+    EBSummary* theEBSummary = &ebsummary;
+    EBGlobal* theGlobalEB = &ebGlobal;
+
+    format::revision formatVersion = format::revision::ROOTvMDC2;
+    std::unique_ptr<Input> input(InputFactory::getInput(get_input_format(input_files)));
+    std::unique_ptr<Output> output;
+    Input* theInput = input.get();
+    Output* theOutput = NULL;
+
+    std::string fileRandomSeed = "";
+    std::string theDERRandomSeed = derRandomSeed;
+    unsigned long posixTime = 0;
+    unsigned long realPosixTime = 0;
+    std::string localTime = "";
+    int dataCollectors = 0;
+    int channelsPerDDC32 = 0;
+    int samplingRate_ns = 0;
+    int ddc32Boards = 0;
+    bool outputIsBinary = false;
+    unsigned int runNumber = 0;
+
+    check_file_permissions(config);
+    setup_input(theInput, input_files);
+    check_pmts_and_events(theInput, config);
+    setup_output(theOutput, formatVersion, outputIsBinary, config);
+    output.reset(theOutput);
+    setup_time_stamp(theOutput, realPosixTime, posixTime, localTime, config);
+    setup_summary(theInput, theOutput, *theDERSummary, input_files, posixTime, realPosixTime, fileRandomSeed,
+        theDERRandomSeed, localTime, *theGlobalEB, dataCollectors, channelsPerDDC32, ddc32Boards, samplingRate_ns,
+        runNumber, config);
+    print_user_info(*theDERSummary);
+    user_check(*theDERSummary, config);
+
+    std::cout << std::endl;
+    std::cout << std::endl;
+
+    setup_pmt_start_int(theInput);
+
+    theOutput->doInitInputVariables(theInput);
+
+    write_summary_objects(theInput, theOutput, theDERSummary, theEBSummary, theGlobalEB);
+
+    //----------------------------------------------------
+    // Recreate the Data Collectors on each event
+    // Currently uses PosixTime. Will become (PosixTime) + (duration [samples = 10 ns] of previous event)
+    DDC32 theDCs(dataCollectors, channelsPerDDC32, posixTime);
+    theDCs.setSamplingRate(samplingRate_ns);
+
+    acquire_and_process_data(theInput, theOutput, theDCs, theEBSummary, config, electronics, firstDoubleGainStage);
+
+    theOutput->doWriteTruthTree();
+
+    theOutput->doWriteTime(timer.RealTime(), timer.CpuTime());
+    // The output is written to a .tmp file that is renamed when it is closed
+    std::string outFileName = theOutput->getOutFileName();
+    const std::string tmpExtension = ".tmp";
+    if (outFileName.size() > tmpExtension.size()
+        && outFileName.compare(outFileName.size() - tmpExtension.size(), tmpExtension.size(), tmpExtension) == 0)
+        outFileName.erase(outFileName.size() - tmpExtension.size());
+    theOutput->CloseFile();
+    output.reset();
+
+    input->Close();
+    return outFileName;
+}
+
 void setup_output(Output*& output, format::revision formatVersion, bool& outputIsBinary, global::ConfigPtr config)
 {
     std::size_t derExtension = 0;
@@ -591,6 +781,9 @@ void displayHelp()
 
     std::cout << "Help and Usage:" << std::endl;
     std::cout << "     ./DER --setting value /path/to/inputfile.root" << std::endl;
+    std::cout << "     ./DER --ConvertToFlat /path/to/outputfile.derflat /path/to/inputfile.root" << std::endl;
+    std::cout << "     ./DER --setting value --BatchList /path/to/list.txt" << std::endl;
+    std::cout << "     ./DER --setting value --Serve /path/to/socket" << std::endl;
     std::cout << "     ./DER or ./DER -h for help" << std::endl;
 }
 
@@ -623,8 +816,8 @@ void set_number_of_threads(global::ConfigPtr config)
     }
 }
 
-void acquire_and_process_data(
-    Input* input, Output* output, DDC32& testDCs, EBSummary* theEBSummary, global::ConfigPtr config)
+void acquire_and_process_data(Input* input, Output* output, DDC32& testDCs, EBSummary* theEBSummary,
+    global::ConfigPtr config, DeviceVectors& electronics, unsigned int firstDoubleGainStage)
 {
 
     std::vector<TStopwatch> timers(4, TStopwatch());
@@ -634,16 +827,64 @@ void acquire_and_process_data(
     double cumulativeCPUTimes[4] = {};
     unsigned long totalPhotons = 0;
 
-    unsigned int firstDoubleGainStage = 0;
-    DeviceVectors electronics = setup_analogue_electronics(firstDoubleGainStage, config);
-
     bool useMCTruth = (config->getConfig("DERMCTruthInfo").c_str() == "true" ? true : false);
     useMCTruth = (electronics[0][0]->getName() == "PMT" ? true : false);
 
     bool fillStagePulses = (config->getConfig("GenerateStageData") == "true" ? true : false);
+
+    // Stage data is captured for these PMTs and stages only (1: PMT,
+    // 2: PMT cable, 3: amplifier, 4: feedthrough cable). Empty means all.
+    std::set<unsigned int> stageDataChannels = parse_number_list(global::get_optional_config("StageDataChannels", "all"));
+    std::set<unsigned int> stageDataStages = parse_number_list(global::get_optional_config("StageDataStages", "all"));
+    std::vector<bool> captureStages(electronics.size() - 1, fillStagePulses);
+    for (size_t i = 0; i < captureStages.size(); ++i)
+        captureStages[i] = fillStagePulses && (stageDataStages.empty() || stageDataStages.count(i + 1));
     bool useS2Trigger = (config->getConfig("UseS2Trigger") == "true" ? true : false);
+    // The integer trigger filter is checked against its floating point
+    // reference once per model, on a fixed stream filtered in chunks.
+    if (useS2Trigger)
+        for (const char* model : { "S2HG", "S2LG" })
+            FPGATrigger(model).checkFilterStream();
     bool writeRawData = (config->getConfig("WriteRawData") == "true" ?  true : false);
 
+    // Segmented pulses only store the photon intervals and filter tails.
+    // Stage data still needs the dense pulses of every device stage.
+    bool sparsePulses = toBool(global::get_optional_config("SparsePulses", "false"));
+    if (sparsePulses && (fillStagePulses || config->getConfig("SignalChain") != "ANALYTIC"))
+    {
+        std::cout << "NOTICE: SparsePulses requires the ANALYTIC signal chain and "
+                  << "GenerateStageData false, using dense pulses" << std::endl;
+        sparsePulses = false;
+    }
+    // Only the segments hold noise: gap samples are the baseline, with their
+    // noise drawn only where a POD covers them.
+    if (sparsePulses)
+    {
+        std::shared_ptr<Digitizer> theDigitizer = std::dynamic_pointer_cast<Digitizer>(electronics.back()[0]);
+        if (theDigitizer && theDigitizer->hasBaselineNoise())
+            std::cout << "NOTICE: SparsePulses with baseline noise forms no PODs from the noise "
+                      << "between the photon intervals, unlike dense pulses" << std::endl;
+        if (global::get_optional_config("PODBaseline", "rolling") != "fixed")
+            std::cout << "NOTICE: SparsePulses with PODBaseline rolling updates the baseline "
+                      << "for every gap sample, fixed only scans the stored samples" << std::endl;
+    }
+
+    // Channels can be processed in time slices of this many samples, going
+    // from the PMT to the PODs slice by slice, so that the memory per channel
+    // does not grow with the event length. 0 processes whole pulses.
+    unsigned long sliceSamples = std::stoul(global::get_optional_config("PulseSliceSamples", "0"));
+    if (sliceSamples && (sparsePulses || fillStagePulses || writeRawData || config->getConfig("SignalChain") != "ANALYTIC"))
+    {
+        std::cout << "NOTICE: PulseSliceSamples requires the ANALYTIC signal chain, dense pulses and "
+                  << "GenerateStageData and WriteRawData false, using whole pulses" << std::endl;
+        sliceSamples = 0;
+    }
+
+    // The PODs of an event are kept in one flat arena per gain and written
+    // from there, unless the S2 trigger, stage data or raw data need them as
+    // POD objects.
+    bool usePODArena = !useS2Trigger && !fillStagePulses && !writeRawData;
+
     ////////////////////////////////////////////////////////////
 
     // 1024 is always added by default to ensure continuous pulse boundaries
@@ -666,6 +907,25 @@ void acquire_and_process_data(
 
     //////////////
 
+    // The photons of the next events can be read in a background thread
+    // while the current event is simulated.
+    input->startPrefetch(std::stoul(global::get_optional_config("PhotonPrefetchDepth", "0")));
+
+    // The events can instead be placed on one continuous timeline, where
+    // overlapping events are acquired together.
+    if (toBool(global::get_optional_config("ContinuousTimeline", "false")))
+    {
+        if (config->getConfig("SignalChain") == "ANALYTIC" && !useS2Trigger && !fillStagePulses && !writeRawData)
+        {
+            timers[0].Stop();
+            acquire_continuous_timeline(input, output, testDCs, theEBSummary, config, electronics,
+                firstDoubleGainStage, timeShift);
+            return;
+        }
+        std::cout << "NOTICE: ContinuousTimeline requires the ANALYTIC signal chain and UseS2Trigger, "
+                  << "GenerateStageData and WriteRawData false, acquiring single events" << std::endl;
+    }
+
     std::cout << "Monomodal Event Acquisition - Jan2018/Feb2018/Mar2018" << std::endl;
     unsigned long long detectorEventCounter = 0;
 
@@ -687,6 +947,12 @@ void acquire_and_process_data(
     }
     unsigned long triggerTime = 0;
     unsigned long previousSamples = 0;
+    PulsePool pulsePool; // HG and LG pulses, reused for every channel
+    SlicedPulse theSlicedPulse; // reused for every channel when slicing
+    PODArena theHGArena; // PODs of the event, reused for every event
+    PODArena theLGArena;
+    PODArena* theHGArenaPtr = (usePODArena ? &theHGArena : nullptr);
+    PODArena* theLGArenaPtr = (usePODArena ? &theLGArena : nullptr);
     unsigned long long nEvents = input->getSelecEvtsSize();
 
     timers[0].Stop();
@@ -722,7 +988,7 @@ void acquire_and_process_data(
         currentEvent.setBufferLiveStartTS(triggerTime);
         currentEvent.setTriggerType(1);
         currentEvent.setTriggerTimeStamp(triggerTime);
-        currentEvent.setTriggerMultiplicity(0); // Set to 0 for now.
+        currentEvent.setTriggerMultiplicity(0); // Set from the S2 trigger if it is used
         output->setTimeStamp(currentEvent);
         output->setTriggerRunNumber(std::stoi(config->getConfig("SimRunNumberID")));
 
@@ -757,6 +1023,8 @@ void acquire_and_process_data(
         PODContainerVector allLGPODs;
         PODContainerVectors allHGStagePODs;
         PODContainerVectors allLGStagePODs;
+        theHGArena.clear();
+        theLGArena.clear();
 
         FPGATrigger S2HGTrigger("S2HG");
         FPGATrigger S2LGTrigger("S2LG");
@@ -783,24 +1051,58 @@ void acquire_and_process_data(
         {
             // Setup the HG and LG pulses
             timers[1].Start();
-	    Pulse theHGPulse;
-            Pulse theLGPulse;
-	    theHGPulse.resize(theCurrentPulse.size());
+            // Pooled pulses are already zeroed, so they are only filled in
+            // the photon intervals and only those are cleared on release.
+            unsigned long pooledSize = (sparsePulses || sliceSamples ? 0 : theCurrentPulse.size());
+            std::shared_ptr<Pulse> theHGPulsePtr = pulsePool.acquire(pooledSize);
+            std::shared_ptr<Pulse> theLGPulsePtr = pulsePool.acquire(pooledSize);
+            Pulse& theHGPulse = *theHGPulsePtr;
+            Pulse& theLGPulse = *theLGPulsePtr;
+            SegmentedPulse theSparseHGPulse;
+            SegmentedPulse theSparseLGPulse;
+	    if (sparsePulses)
+	      theSparseHGPulse.reset(theCurrentPulse.size());
 
 	    input->getPMTData(input->getSelecEvtsAt(k), j, std::dynamic_pointer_cast<PMT>(electronics[0][0]), theCurrentPulse.size(), timeShift, timeShiftInc, k);
             theHGPulse.setChannel(pmtsInEvt[j]);
             theHGPulse.setEvent(output->EvtNum());
             theHGPulse.setLUXSimEvtNum(0, input->getSelecEvtsAt(k));
+            theSparseHGPulse.setChannel(pmtsInEvt[j]);
+            theSparseHGPulse.setEvent(output->EvtNum());
+            theSparseHGPulse.setLUXSimEvtNum(input->getSelecEvtsAt(k));
+            std::shared_ptr<PODContainer> theSlicedHGPODs;
+            std::shared_ptr<PODContainer> theSlicedLGPODs;
+            if (sliceSamples)
+            {
+                theSlicedPulse.reset(theCurrentPulse.size());
+                theSlicedPulse.setChannel(pmtsInEvt[j]);
+                theSlicedPulse.setEvent(output->EvtNum());
+                theSlicedHGPODs.reset(new PODContainer());
+                theSlicedLGPODs.reset(new PODContainer());
+                theSlicedHGPODs->setArena(theHGArenaPtr);
+                theSlicedLGPODs->setArena(theLGArenaPtr);
+            }
             timers[1].Stop();
 
             // Setup the stage pulses to be used in the PODViewer
-            PulseVectors allStagePulses(
-                electronics.size() - 1, std::vector<std::shared_ptr<Pulse> >(1, std::shared_ptr<Pulse>()));
+            SegmentedPulseVectors allStagePulses(
+                electronics.size() - 1, std::vector<std::shared_ptr<SegmentedPulse> >(1, std::shared_ptr<SegmentedPulse>()));
+            bool captureChannel = stageDataChannels.empty() || stageDataChannels.count(pmtsInEvt[j]);
 
             // Find the electronics response
             //---------------------------------------------------------
             timers[2].Start();
-            do_analogue_electronics_response(electronics, theLGPulse, theHGPulse, allStagePulses, firstDoubleGainStage, fillStagePulses);
+            unsigned long slicedSize = 0;
+            size_t firstHGArenaPOD = theHGArena.size();
+            size_t firstLGArenaPOD = theLGArena.size();
+            if (sliceSamples)
+                slicedSize = do_sliced_electronics_response(electronics, theSlicedPulse, *theSlicedLGPODs, *theSlicedHGPODs,
+                    firstDoubleGainStage, sliceSamples);
+            else if (sparsePulses)
+                do_sparse_electronics_response(electronics, theSparseLGPulse, theSparseHGPulse, firstDoubleGainStage);
+            else
+                do_analogue_electronics_response(electronics, theLGPulse, theHGPulse, allStagePulses, firstDoubleGainStage,
+                    (captureChannel ? captureStages : std::vector<bool>()));
             timers[2].Stop();
 
             // Setup MCTruth object
@@ -812,8 +1114,27 @@ void acquire_and_process_data(
             }
 
             // Create the PODs
-            allHGPODs.push_back(std::move(create_pods(theHGPulse, theMCTruth, "HG", config)));
-            allLGPODs.push_back(std::move(create_pods(theLGPulse, theMCTruth, "LG", config)));
+            if (sliceSamples)
+            { // already formed slice by slice, add the truth as create_pods() would
+                theHGArena.setMCTruth(firstHGArenaPOD, theMCTruth);
+                theLGArena.setMCTruth(firstLGArenaPOD, theMCTruth);
+                for (auto& thePOD : *theSlicedHGPODs)
+                    thePOD->setMCTruth(theMCTruth);
+                for (auto& thePOD : *theSlicedLGPODs)
+                    thePOD->setMCTruth(theMCTruth);
+                allHGPODs.push_back(theSlicedHGPODs);
+                allLGPODs.push_back(theSlicedLGPODs);
+            }
+            else if (sparsePulses)
+            {
+                allHGPODs.push_back(std::move(create_pods(theSparseHGPulse, theMCTruth, "HG", config, theHGArenaPtr)));
+                allLGPODs.push_back(std::move(create_pods(theSparseLGPulse, theMCTruth, "LG", config, theLGArenaPtr)));
+            }
+            else
+            {
+                allHGPODs.push_back(std::move(create_pods(theHGPulse, theMCTruth, "HG", config, theHGArenaPtr)));
+                allLGPODs.push_back(std::move(create_pods(theLGPulse, theMCTruth, "LG", config, theLGArenaPtr)));
+            }
 
             if (useS2Trigger)
             {
@@ -827,19 +1148,49 @@ void acquire_and_process_data(
 	    }
 
 	    if (writeRawData && output->getOutputFormat() == format::revision::ROOTvMDC2){
+	      if (sparsePulses){
+		theSparseLGPulse.fillDense(theLGPulse);
+		theSparseHGPulse.fillDense(theHGPulse);
+	      }
 	      output->doWriteRawData(theLGPulse, theHGPulse, 
 				     allLGPODs[allLGPODs.size() - 1], allHGPODs[allHGPODs.size() - 1]);
 	    }
             output->doWriteDERMCTruth(theMCTruth);
 
-            previousSamples = (double)theLGPulse.size() / (double)samplingRate_ns;
+            if (sliceSamples)
+                previousSamples = (double)slicedSize / (double)samplingRate_ns;
+            else
+                previousSamples = (double)(sparsePulses ? theSparseLGPulse.size() : theLGPulse.size()) / (double)samplingRate_ns;
+
+            if (sparsePulses)
+            { // the dense view is not zero outside the photon intervals
+                theHGPulsePtr.reset();
+                theLGPulsePtr.reset();
+            }
+            pulsePool.release(theHGPulsePtr);
+            pulsePool.release(theLGPulsePtr);
         }
         theEBSummary->setEndFlag(0);
 
+        if (useS2Trigger)
+        { // all trigger types of each gain in one merged pass over its trigger points
+            for (FPGATrigger* theTrigger : { &S2HGTrigger, &S2LGTrigger })
+            {
+                for (const FPGATrigger::EventTrigger& theEventTrigger : theTrigger->buildEventTriggers())
+                {
+                    if (currentEvent.getTriggerMultiplicity() == 0
+                        && theTrigger->getTriggerTypes()[theEventTrigger.type].kind == FPGATrigger::kMultiplicity)
+                        currentEvent.setTriggerMultiplicity((short)theEventTrigger.value);
+                }
+            }
+        }
+
         // Build the events
         timers[3].Start();
-        unsigned int numberOfHGPODs = build_event(allHGPODs, output, allHGStagePODs, config);
-        unsigned int numberOfLGPODs = build_event(allLGPODs, output, allLGStagePODs, config);
+        unsigned int numberOfHGPODs = (usePODArena ? build_event(theHGArena, output)
+                                                   : build_event(allHGPODs, output, allHGStagePODs, config));
+        unsigned int numberOfLGPODs = (usePODArena ? build_event(theLGArena, output)
+                                                   : build_event(allLGPODs, output, allLGStagePODs, config));
         timers[3].Stop();
 
         liveStop = triggerTime + previousSamples;
@@ -858,24 +1209,134 @@ void acquire_and_process_data(
                 cumulativeCPUTimes);
         }
     }
+    input->stopPrefetch();
+    if (config->getConfig("PrintInfo") == "true")
+        electronics[0][0]->printRunningTime();
+}
+
+void acquire_continuous_timeline(Input* input, Output* output, DDC32& testDCs, EBSummary* theEBSummary,
+    global::ConfigPtr config, DeviceVectors& electronics, unsigned int firstDoubleGainStage,
+    unsigned long long timeShift)
+{
+    // The input events happen at Poisson distributed times on one timeline,
+    // at TimelineEventRate. The response of each channel is added to the
+    // Timeline at the time of its event, so that events closer than their
+    // window overlap as they would in the detector. When an event is added,
+    // everything before it is final and the PODs completed up to there are
+    // written as one output event. This acquisition is untriggered: no S2
+    // trigger decides the events, which are only split at the input event
+    // times. There is no baseline noise between the islands of the Timeline.
+    // MCTruth is not kept, since a POD can mix photons of several input
+    // events.
+    double eventRate = std::stod(global::get_optional_config("TimelineEventRate", "100")); //[Hz]
+    if (!(eventRate > 0))
+        throw std::runtime_error("RunControl: TimelineEventRate must be > 0");
+
+    std::cout << "Continuous Timeline Acquisition at " << eventRate << " Hz, untriggered" << std::endl;
+
+    int samplingRate_ns = testDCs.getSamplingRate();
+    double meanEventSpacing = 1e9 / eventRate / samplingRate_ns; //[samples]
+    std::shared_ptr<PMT> thePMT = std::dynamic_pointer_cast<PMT>(electronics[0][0]);
+    Timeline theTimeline(std::dynamic_pointer_cast<Digitizer>(electronics.back()[0]));
+    PulsePool pulsePool;
+    PODArena theHGArena;
+    PODArena theLGArena;
+    std::vector<double> theLGResponse;
+    std::vector<double> theHGResponse;
+
+    output->setSignalChainIdentifier(format::SignalChain::ANALYTIC);
+    output->setTriggerRunNumber(std::stoi(config->getConfig("SimRunNumberID")));
+
+    unsigned long long eventTime = 0; //[samples]
+    unsigned long long liveStart = 0;
+    unsigned long long nEvents = input->getSelecEvtsSize();
+    unsigned long long nWritten = 0;
+    for (unsigned long long k = 0; k < nEvents; k++)
+    {
+        unsigned long long nPhot = 0;
+        unsigned long long tMin = 0;
+        unsigned long long tMax = 0;
+        unsigned long long nVert = 0;
+        std::vector<int> pmtsInEvt;
+
+        input->makePMTDataReady(input->getSelecEvtsAt(k), nPhot, tMin, tMax, nVert, pmtsInEvt);
+
+        std::cout << progress_status(k, input->getSelecEvtsSize()) << "\r" << std::flush;
+
+        eventTime += (unsigned long long)std::llround(gRandom->Exp(meanEventSpacing));
+        theTimeline.advance(eventTime, theLGArena, theHGArena);
+        if (write_timeline_event(theLGArena, theHGArena, output, liveStart, eventTime))
+        {
+            theEBSummary->setEndFlag(0);
+            ++nWritten;
+        }
+        liveStart = eventTime;
+
+        if (nPhot == 0)
+        {
+            std::cout << "Event " << input->getSelecEvtsAt(k) << " is empty." << std::endl;
+            std::cout << "Skip to next event..." << std::endl;
+            continue;
+        }
+
+        Pulse theCurrentPulse;
+        PulseManager prep(samplingRate_ns);
+        prep.PrepareEventBounds(theCurrentPulse, 0, tMax + timeShift);
+
+        for (unsigned int j = 0; j < pmtsInEvt.size(); j++)
+        {
+            std::shared_ptr<Pulse> theHGPulsePtr = pulsePool.acquire(theCurrentPulse.size());
+            std::shared_ptr<Pulse> theLGPulsePtr = pulsePool.acquire(theCurrentPulse.size());
+            input->getPMTData(input->getSelecEvtsAt(k), j, thePMT, theCurrentPulse.size(), timeShift, 0, k);
+            theHGPulsePtr->setChannel(pmtsInEvt[j]);
+            theHGPulsePtr->setLUXSimEvtNum(0, input->getSelecEvtsAt(k));
+
+            do_timeline_electronics_response(electronics, *theLGPulsePtr, *theHGPulsePtr, firstDoubleGainStage,
+                theLGResponse, theHGResponse);
+            theTimeline.addResponse(pmtsInEvt[j], eventTime, theLGResponse, theHGResponse);
+
+            pulsePool.release(theHGPulsePtr);
+            pulsePool.release(theLGPulsePtr);
+        }
+    }
+
+    theTimeline.finish(theLGArena, theHGArena);
+    if (write_timeline_event(theLGArena, theHGArena, output, liveStart, theTimeline.getHorizon()))
+    {
+        theEBSummary->setEndFlag(0);
+        ++nWritten;
+    }
+
+    std::cout << std::endl;
+    std::cout << "Timeline of " << theTimeline.getHorizon() * samplingRate_ns * 1e-6 << " ms written as "
+              << nWritten << " untriggered events, split at the input event times" << std::endl;
+    input->stopPrefetch();
     if (config->getConfig("PrintInfo") == "true")
         electronics[0][0]->printRunningTime();
 }
 
 void do_analogue_electronics_response(DeviceVectors& electronics, Pulse& theLGPulse, Pulse& theHGPulse,
-				      PulseVectors& allStagePulses, unsigned int firstDoubleGainStage, bool fillStagePulses)
+				      SegmentedPulseVectors& allStagePulses, unsigned int firstDoubleGainStage,
+				      const std::vector<bool>& captureStages)
 {
+    // Stages are captured as segmented pulses holding the photon intervals
+    // only, which is where an undigitised pulse is non-zero.
+    bool fillStagePulses = std::find(captureStages.begin(), captureStages.end(), true) != captureStages.end();
     unsigned int stageNumber = 0;
     for (auto deviceStage : electronics)
     {
+      bool captureStage = stageNumber < captureStages.size() && captureStages[stageNumber];
       if(deviceStage.size()>0){
         if (stageNumber < firstDoubleGainStage)
         { // single pulse
             deviceStage[0]->doResponse(theHGPulse);
-            if(fillStagePulses) allStagePulses[stageNumber][0].reset(new Pulse(theHGPulse));
+            if(captureStage){
+              allStagePulses[stageNumber][0].reset(new SegmentedPulse());
+              allStagePulses[stageNumber][0]->assignTouched(theHGPulse);
+            }
             if (stageNumber + 1 == firstDoubleGainStage)
             { // at this point, split into HG & LG
-                theLGPulse = theHGPulse;
+                theLGPulse.assignTouched(theHGPulse);
             }
         }
         else
@@ -892,18 +1353,21 @@ void do_analogue_electronics_response(DeviceVectors& electronics, Pulse& theLGPu
 	    if(fillStagePulses){
 	      if (stageNumber + 1 < electronics.size())
 		{
-		  allStagePulses[stageNumber][0].reset(new Pulse(theLGPulse));
-		  allStagePulses[stageNumber].push_back(std::shared_ptr<Pulse>());
-		  allStagePulses[stageNumber][1].reset(new Pulse(theHGPulse));
+		  allStagePulses[stageNumber].resize(2);
+		  if(captureStage){
+		    allStagePulses[stageNumber][0].reset(new SegmentedPulse());
+		    allStagePulses[stageNumber][0]->assignTouched(theLGPulse);
+		    allStagePulses[stageNumber][1].reset(new SegmentedPulse());
+		    allStagePulses[stageNumber][1]->assignTouched(theHGPulse);
+		  }
 		}
 	      else
 		{
-		  for (auto stagePulses : allStagePulses)
+		  for (auto& stagePulses : allStagePulses)
 		    { // Apply the digitiser to all of them
-		      if (stagePulses.size() > 1)
-                        deviceStage[0]->doStageResponse(*stagePulses[0], *stagePulses[1]);
-		      else
-                        deviceStage[0]->doStageResponse(*stagePulses[0]);
+		      for (auto& stagePulse : stagePulses)
+			if (stagePulse)
+			  deviceStage[0]->doStageResponse(*stagePulse);
 		    }
 		}
 	    }
@@ -913,6 +1377,129 @@ void do_analogue_electronics_response(DeviceVectors& electronics, Pulse& theLGPu
     }
 }
 
+void do_sparse_electronics_response(DeviceVectors& electronics, SegmentedPulse& theLGPulse, SegmentedPulse& theHGPulse,
+    unsigned int firstDoubleGainStage)
+{
+    unsigned int stageNumber = 0;
+    for (auto& deviceStage : electronics)
+    {
+        if (deviceStage.size() > 0)
+        {
+            if (stageNumber < firstDoubleGainStage)
+            { // single pulse
+                deviceStage[0]->doResponse(theHGPulse);
+                if (stageNumber + 1 == firstDoubleGainStage)
+                    theLGPulse = theHGPulse; // split into HG & LG
+            }
+            else if (deviceStage.size() == 2)
+            { // separate processing for HG & LG
+                deviceStage[0]->doResponse(theLGPulse);
+                deviceStage[1]->doResponse(theHGPulse);
+            }
+            else
+            {
+                deviceStage[0]->doResponse(theLGPulse, theHGPulse);
+            }
+        }
+        ++stageNumber;
+    }
+}
+
+void do_timeline_electronics_response(DeviceVectors& electronics, Pulse& theLGPulse, Pulse& theHGPulse,
+    unsigned int firstDoubleGainStage, std::vector<double>& theLGResponse, std::vector<double>& theHGResponse)
+{
+    // As do_analogue_electronics_response() up to the ADC: the digitiser
+    // only samples the response of both gains [mV], which are digitised by
+    // the Timeline once the responses of all events are added.
+    std::shared_ptr<Digitizer> theDigitizer = std::dynamic_pointer_cast<Digitizer>(electronics.back()[0]);
+    for (unsigned int stageNumber = 0; stageNumber + 1 < electronics.size(); ++stageNumber)
+    {
+        std::vector<std::shared_ptr<Device> >& deviceStage = electronics[stageNumber];
+        if (deviceStage.empty())
+            continue;
+        if (stageNumber < firstDoubleGainStage)
+        { // single pulse
+            deviceStage[0]->doResponse(theHGPulse);
+            if (stageNumber + 1 == firstDoubleGainStage)
+                theLGPulse.assignTouched(theHGPulse); // split into HG & LG
+        }
+        else if (deviceStage.size() == 2)
+        { // separate processing for HG & LG
+            deviceStage[0]->doResponse(theLGPulse);
+            deviceStage[1]->doResponse(theHGPulse);
+        }
+        else
+        {
+            deviceStage[0]->doResponse(theLGPulse, theHGPulse);
+        }
+    }
+    theDigitizer->decimateResponse(theLGPulse, theLGResponse);
+    theDigitizer->decimateResponse(theHGPulse, theHGResponse);
+}
+
+unsigned long do_sliced_electronics_response(DeviceVectors& electronics, SlicedPulse& thePulse, PODContainer& theLGPODs,
+    PODContainer& theHGPODs, unsigned int firstDoubleGainStage, unsigned long sliceSamples)
+{
+    // Each gain is processed in its own pass over the slices, LG first, so
+    // that random numbers are drawn in the same order as for whole pulses:
+    // the PMT amplitudes, then the LG and then the HG digitiser noise. The
+    // stages before the split into HG & LG are deterministic and are run in
+    // both passes. A device only uses the samples and photon intervals that
+    // the stages before it are done with, so the PODs are identical to those
+    // of whole pulses. The PODs are formed without MCTruth, which is only
+    // prepared after the response. Returns the digitised pulse length.
+    std::shared_ptr<PMT> thePMT = std::dynamic_pointer_cast<PMT>(electronics[0][0]);
+    std::shared_ptr<Digitizer> theDigitizer = std::dynamic_pointer_cast<Digitizer>(electronics.back()[0]);
+    unsigned long length = thePulse.getLength();
+    unsigned long digitizedSize = 0;
+    std::vector<double> digitized;
+
+    for (unsigned int gain = 0; gain < 2; ++gain)
+    {
+        PODContainer& thePODs = (gain == 0 ? theLGPODs : theHGPODs);
+        thePulse.reset(length);
+        if (gain == 0)
+            thePMT->doResponse(thePulse);
+        else
+            thePMT->repeatResponse(thePulse);
+
+        std::vector<std::shared_ptr<Device> > chain; // devices after the PMT
+        for (unsigned int stage = 1; stage < electronics.size(); ++stage)
+            chain.push_back(electronics[stage][(stage >= firstDoubleGainStage && electronics[stage].size() == 2) ? gain : 0]);
+        std::vector<Device::SliceState> states(chain.size());
+        for (size_t k = 0; k < chain.size(); ++k)
+            chain[k]->startResponse(thePulse, states[k]);
+        digitizedSize = theDigitizer->startSlicedResponse(thePulse);
+        thePODs.setBaseline(theDigitizer->getBaseline(), theDigitizer->getBaselineSigma(thePulse.getChannel()));
+        thePODs.startPODContainer(thePulse.getChannel(), thePulse.getEvent(), thePulse.getLUXSimRunNumber(),
+            digitizedSize, std::shared_ptr<MCTruth>(), (gain == 0 ? "LG" : "HG"));
+
+        unsigned long sliceEnd = 0;
+        while (sliceEnd < length)
+        {
+            unsigned long sliceStart = sliceEnd;
+            sliceEnd = std::min(length, sliceEnd + sliceSamples);
+            thePulse.extendWindow(sliceEnd);
+            thePMT->fillSlice(thePulse, sliceStart, sliceEnd);
+
+            unsigned long sampleLimit = sliceEnd;
+            unsigned int intervalLimit = thePulse.getPhotonSize();
+            for (size_t k = 0; k < chain.size(); ++k)
+            {
+                chain[k]->doResponse(thePulse, states[k], sampleLimit, intervalLimit);
+                sampleLimit = std::min(sampleLimit, chain[k]->getSampleFrontier(thePulse, states[k]));
+                intervalLimit = std::min(intervalLimit, chain[k]->getIntervalFrontier(thePulse, states[k]));
+            }
+
+            theDigitizer->digitizeSlice(thePulse, sampleLimit, digitized);
+            thePODs.addPODContainerSamples(digitized);
+            thePulse.discardBefore(sampleLimit);
+        }
+        thePODs.finishPODContainer();
+    }
+    return digitizedSize;
+}
+
 DeviceVectors setup_analogue_electronics(unsigned int& firstDoubleGainStage, global::ConfigPtr config)
 {
     DeviceVectors devices; // LG and HG chains;
@@ -938,10 +1525,33 @@ DeviceVectors setup_analogue_electronics(unsigned int& firstDoubleGainStage, glo
     return devices;
 }
 
-std::shared_ptr<PODContainer> create_pods(
-    Pulse& thePulse, std::shared_ptr<MCTruth> theMCTruth, std::string gainOption, global::ConfigPtr config)
+void setup_noise_devices(DeviceVectors& electronics, global::ConfigPtr config)
+{
+    /**
+     * Build the digitizer, the last stage of both chains, again. It is the
+     * only device that draws random numbers when it is made, for its noise
+     * banks, so after the seed is set this gives the electronics of a run on
+     * its own without reading the PMT pulse templates again.
+     */
+    der::DeviceModel model
+        = (config->getConfig("SignalChain") == "SAMPLED" ? der::DeviceModel::kSampled : der::DeviceModel::kAnalytic);
+    electronics.back().back() = DeviceFactory::getDevice("Digitizer", model);
+}
+
+std::shared_ptr<PODContainer> create_pods(Pulse& thePulse, std::shared_ptr<MCTruth> theMCTruth,
+    std::string gainOption, global::ConfigPtr config, PODArena* arena)
+{
+    std::shared_ptr<PODContainer> thePODContainer(new PODContainer());
+    thePODContainer->setArena(arena);
+    thePODContainer->fillPODContainerFromPulse(thePulse, theMCTruth, gainOption);
+    return thePODContainer;
+}
+
+std::shared_ptr<PODContainer> create_pods(SegmentedPulse& thePulse, std::shared_ptr<MCTruth> theMCTruth,
+    std::string gainOption, global::ConfigPtr config, PODArena* arena)
 {
     std::shared_ptr<PODContainer> thePODContainer(new PODContainer());
+    thePODContainer->setArena(arena);
     thePODContainer->fillPODContainerFromPulse(thePulse, theMCTruth, gainOption);
     return thePODContainer;
 }
@@ -979,13 +1589,29 @@ void run_trigger_on_pods(
     allStagePODs.push_back(stagePODs);
 }
 
-void create_stage_pods(PODContainerVectors& allStagePODs, PulseVectors& allStagePulses,
+void create_stage_pods(PODContainerVectors& allStagePODs, SegmentedPulseVectors& allStagePulses,
 		       std::shared_ptr<PODContainer>& thePODContainer, std::string gainOption, bool useS2Trigger)
 {
     bool newPODVector = true;
     if (useS2Trigger)
         newPODVector = false;
 
+    // A channel without any captured stage writes no stage data at all,
+    // while stages that were not selected give PODs without samples.
+    bool channelCaptured = false;
+    for (auto& stagePulses : allStagePulses)
+        for (auto& stagePulse : stagePulses)
+            if (stagePulse)
+                channelCaptured = true;
+    if (!channelCaptured)
+    {
+        if (newPODVector)
+            allStagePODs.push_back(PODContainerVector());
+        else
+            allStagePODs.back().clear();
+        return;
+    }
+
     PODContainerVector stagePODs;
     for (size_t i = 0; i < allStagePulses.size(); ++i)
     {
@@ -1040,6 +1666,101 @@ unsigned int build_event(
     return numberOfPODs;
 }
 
+unsigned int build_event(PODArena& thePODs, Output* output)
+{
+    /**
+     * Write the PODs of the event kept in thePODs and return their number.
+     */
+    output->doWriteData(thePODs);
+    return thePODs.size();
+}
+
+unsigned int write_timeline_event(PODArena& theLGPODs, PODArena& theHGPODs, Output* output,
+    const unsigned long long& liveStart, const unsigned long long& liveStop)
+{
+    /**
+     * Write the PODs cut from the timeline between liveStart and liveStop as
+     * one event, if there are any, and return their number. No trigger is
+     * run: the trigger time stamp is the start of the first POD and the POD
+     * start times, which are absolute on the timeline, are made relative to
+     * it.
+     */
+    if (theLGPODs.size() + theHGPODs.size() == 0)
+        return 0;
+
+    PODArena* theArenas[2] = { &theHGPODs, &theLGPODs };
+    unsigned long long triggerTime = std::numeric_limits<unsigned long long>::max();
+    for (PODArena* theArena : theArenas)
+        for (size_t i = 0; i < theArena->size(); ++i)
+            triggerTime = std::min(triggerTime, theArena->at(i).start);
+
+    output->IncEvtNum();
+    for (PODArena* theArena : theArenas)
+        for (size_t i = 0; i < theArena->size(); ++i)
+        {
+            theArena->at(i).start -= triggerTime;
+            theArena->at(i).event = output->EvtNum();
+        }
+
+    EBEvent currentEvent;
+    currentEvent.setBufferLiveStartTS(liveStart);
+    currentEvent.setBufferLiveStopTS(liveStop);
+    currentEvent.setTriggerType(1);
+    currentEvent.setTriggerTimeStamp(triggerTime);
+    currentEvent.setTriggerMultiplicity(0);
+    currentEvent.setEvtSeqNumb(output->EvtNum());
+    output->setTimeStamp(currentEvent);
+    output->doPrepareEvent();
+    output->doPreparePulseMCTruth(0, 0);
+
+    unsigned int numberOfPODs = build_event(theHGPODs, output) + build_event(theLGPODs, output);
+
+    output->doWriteEvent(currentEvent);
+    output->doWriteDetectorMCTruthEvent();
+    output->doResolveEvtPtrs();
+    theHGPODs.clear();
+    theLGPODs.clear();
+    return numberOfPODs;
+}
+
+std::set<unsigned int> parse_number_list(const std::string& list)
+{
+    /**
+     * Parse a DERCONFIG list of numbers such as "1,3,5-8" into a set.
+     * "all" (or an empty string) gives an empty set, meaning no restriction.
+     */
+    std::set<unsigned int> numbers;
+    std::string s = list;
+    s.erase(std::remove(s.begin(), s.end(), ' '), s.end());
+    if (s.empty() || s == "all")
+        return numbers;
+
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, ','))
+    {
+        if (part.empty())
+            continue;
+        size_t dash = part.find('-');
+        try
+        {
+            if (dash == std::string::npos)
+                numbers.insert(std::stoul(part));
+            else
+                for (unsigned long k = std::stoul(part.substr(0, dash)); k <= std::stoul(part.substr(dash + 1)); ++k)
+                    numbers.insert(k);
+        }
+        catch (...)
+        {
+            std::stringstream err_msg{ "" };
+            err_msg << "ERROR: Could not read number list " << list << std::endl;
+            err_msg << "A user input error is assumed." << std::endl;
+            throw std::runtime_error(err_msg.str());
+        }
+    }
+    return numbers;
+}
+
 std::string progress_status(const unsigned long long& it, const unsigned long& total)
 {
     /**
@@ -0,0 +1,316 @@
+//
+//  SegmentedPulse.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <algorithm>
+
+#include "SegmentedPulse.hpp"
+#include "TRandom.h"
+
+SegmentedPulse::SegmentedPulse()
+    : fLength(0)
+    , fGapValue(0)
+    , fGapSigma(0)
+    , fEventID(0)
+    , fChannel(0)
+    , fLuxSimRunNumber(-1)
+    , fLuxSimEvtNum(0)
+    , fCursor(0)
+{
+    /**
+     * Constructor for SegmentedPulse.
+     */
+}
+
+SegmentedPulse::~SegmentedPulse()
+{
+    /**
+     * Destructor for SegmentedPulse.
+     */
+}
+
+void SegmentedPulse::reset(const unsigned long& length, const double& gapValue)
+{
+    /**
+     * Drop all segments and start an empty pulse of the given logical
+     * length.
+     */
+    fLength = length;
+    fGapValue = gapValue;
+    fGapSigma = 0;
+    fIntervals.clear();
+    fSegments.clear();
+    fCursor = 0;
+}
+
+unsigned long SegmentedPulse::size() const
+{
+    return fLength;
+}
+
+void SegmentedPulse::setGapValue(const double& gapValue)
+{
+    fGapValue = gapValue;
+}
+
+double SegmentedPulse::getGapValue() const
+{
+    return fGapValue;
+}
+
+void SegmentedPulse::setGapSigma(const double& gapSigma)
+{
+    fGapSigma = gapSigma;
+}
+
+double SegmentedPulse::getGapSigma() const
+{
+    return fGapSigma;
+}
+
+void SegmentedPulse::setChannel(unsigned int cn)
+{
+    fChannel = cn;
+}
+
+unsigned int SegmentedPulse::getChannel() const
+{
+    return fChannel;
+}
+
+void SegmentedPulse::setEvent(const unsigned long long& evt)
+{
+    fEventID = evt;
+}
+
+unsigned long long SegmentedPulse::getEvent() const
+{
+    return fEventID;
+}
+
+void SegmentedPulse::setLUXSimRunNumber(int rnum)
+{
+    fLuxSimRunNumber = rnum;
+}
+
+int SegmentedPulse::getLUXSimRunNumber() const
+{
+    return fLuxSimRunNumber;
+}
+
+void SegmentedPulse::setLUXSimEvtNum(const unsigned long long& sim)
+{
+    fLuxSimEvtNum = sim;
+}
+
+unsigned long long SegmentedPulse::getLUXSimEvtNum() const
+{
+    return fLuxSimEvtNum;
+}
+
+void SegmentedPulse::addInterval(const unsigned long& start, const unsigned long& end)
+{
+    /**
+     * Register the interval [start, end) as active. Intervals only take
+     * effect after buildSegments(). The same 20 sample margin as
+     * Pulse::addPhotonInterval is added to let the response return to ~0.
+     */
+    unsigned long stop = std::min(end + 20, fLength);
+    if (start < stop)
+        fIntervals.push_back(std::make_pair(start, stop));
+}
+
+void SegmentedPulse::buildSegments()
+{
+    /**
+     * Merge the registered intervals with each other and with the existing
+     * segments, and allocate gap-valued storage for the new samples.
+     */
+    if (fIntervals.empty())
+        return;
+
+    for (auto& segment : fSegments)
+        fIntervals.push_back(std::make_pair(segment.start, segment.end()));
+    std::sort(fIntervals.begin(), fIntervals.end());
+
+    std::vector<Segment> merged;
+    for (auto& interval : fIntervals)
+    {
+        if (merged.empty() || interval.first > merged.back().end())
+        {
+            merged.push_back(Segment());
+            merged.back().start = interval.first;
+        }
+        if (interval.second > merged.back().end())
+            merged.back().samples.resize(interval.second - merged.back().start, fGapValue);
+    }
+    fIntervals.clear();
+
+    // Copy back the samples that were already present.
+    size_t m = 0;
+    for (auto& segment : fSegments)
+    {
+        while (merged[m].end() < segment.end())
+            ++m;
+        std::copy(segment.samples.begin(), segment.samples.end(),
+            merged[m].samples.begin() + (segment.start - merged[m].start));
+    }
+
+    fSegments.swap(merged);
+    fCursor = 0;
+}
+
+size_t SegmentedPulse::getNSegments() const
+{
+    return fSegments.size();
+}
+
+SegmentedPulse::Segment& SegmentedPulse::getSegment(const size_t& i)
+{
+    return fSegments[i];
+}
+
+const SegmentedPulse::Segment& SegmentedPulse::getSegment(const size_t& i) const
+{
+    return fSegments[i];
+}
+
+void SegmentedPulse::setSegments(std::vector<Segment>& segments, const unsigned long& length)
+{
+    /**
+     * Replace the segments by the given ones, which must be sorted,
+     * non-overlapping and within length, the new logical length. The
+     * argument is left with the previous segments.
+     */
+    fLength = length;
+    fSegments.swap(segments);
+    fCursor = 0;
+}
+
+void SegmentedPulse::extendSegment(const size_t& i, const unsigned long& newEnd)
+{
+    /**
+     * Grow segment i up to newEnd with gap-valued samples, e.g. for a
+     * filter tail. Segments that are reached are merged into segment i.
+     */
+    unsigned long stop = std::min(newEnd, fLength);
+    Segment& segment = fSegments[i];
+    while (segment.end() < stop)
+    {
+        if (i + 1 < fSegments.size() && fSegments[i + 1].start <= stop)
+        {
+            Segment& next = fSegments[i + 1];
+            segment.samples.resize(next.start - segment.start, fGapValue);
+            segment.samples.insert(segment.samples.end(), next.samples.begin(), next.samples.end());
+            fSegments.erase(fSegments.begin() + i + 1);
+        }
+        else
+            segment.samples.resize(stop - segment.start, fGapValue);
+    }
+    fCursor = i;
+}
+
+unsigned long SegmentedPulse::getNStoredSamples() const
+{
+    unsigned long n = 0;
+    for (auto& segment : fSegments)
+        n += segment.samples.size();
+    return n;
+}
+
+size_t SegmentedPulse::findSegment(const unsigned long& i) const
+{
+    /**
+     * Index of the segment holding sample i, or getNSegments() if i is in
+     * a gap. Increasing i is resolved from the cursor without a search.
+     */
+    if (fSegments.empty())
+        return 0;
+
+    if (fCursor >= fSegments.size() || fSegments[fCursor].start > i)
+    {
+        auto it = std::upper_bound(fSegments.begin(), fSegments.end(), i,
+            [](const unsigned long& idx, const Segment& s) { return idx < s.start; });
+        fCursor = (it == fSegments.begin() ? 0 : (it - fSegments.begin()) - 1);
+    }
+    while (fCursor + 1 < fSegments.size() && fSegments[fCursor + 1].start <= i)
+        ++fCursor;
+
+    const Segment& segment = fSegments[fCursor];
+    if (i >= segment.start && i < segment.end())
+        return fCursor;
+    return fSegments.size();
+}
+
+double SegmentedPulse::sample(const unsigned long& i) const
+{
+    size_t s = findSegment(i);
+    if (s == fSegments.size())
+        return fGapValue;
+    return fSegments[s].samples[i - fSegments[s].start];
+}
+
+double SegmentedPulse::sample(const unsigned long& i, double& variance) const
+{
+    /**
+     * As sample(i), also returning the variance of the value: 0 for
+     * stored samples and getGapSigma()^2 for gap samples.
+     */
+    size_t s = findSegment(i);
+    if (s == fSegments.size())
+    {
+        variance = fGapSigma * fGapSigma;
+        return fGapValue;
+    }
+    variance = 0;
+    return fSegments[s].samples[i - fSegments[s].start];
+}
+
+void SegmentedPulse::assignTouched(const Pulse& thePulse)
+{
+    /**
+     * Store the samples of a dense pulse inside its photon intervals. Before
+     * digitisation a dense pulse is zero outside these intervals, so with a
+     * gap value of 0 nothing is lost.
+     */
+    reset(thePulse.size());
+    fChannel = thePulse.getChannel();
+    fEventID = thePulse.getEvent();
+    fLuxSimRunNumber = thePulse.getLUXSimRunNumber();
+    for (size_t i = 0; i < thePulse.getPhotonSize(); ++i)
+    {
+        const std::pair<unsigned int, unsigned int>& interval = thePulse.getPhotonIntervalAt(i);
+        if (interval.second > interval.first)
+            fIntervals.push_back(std::make_pair((unsigned long)interval.first,
+                std::min((unsigned long)interval.second, fLength)));
+    }
+    buildSegments();
+    for (auto& segment : fSegments)
+        std::copy(thePulse.begin() + segment.start, thePulse.begin() + segment.end(), segment.samples.begin());
+}
+
+void SegmentedPulse::fillDense(Pulse& thePulse) const
+{
+    /**
+     * Dense view of the pulse, for debugging and for the raw data output.
+     * Gap samples are drawn around the gap value with the gap spread, like
+     * the POD samples in gaps but independently of them.
+     */
+    thePulse.assign(fLength, fGapValue);
+    if (fGapSigma > 0)
+        for (auto& theSample : thePulse)
+            theSample = round(gRandom->Gaus(fGapValue, fGapSigma));
+    thePulse.setChannel(fChannel);
+    thePulse.setEvent(fEventID);
+    thePulse.setLUXSimRunNumber(fLuxSimRunNumber);
+    thePulse.setLUXSimEvtNum(0, fLuxSimEvtNum);
+    for (auto& segment : fSegments)
+    {
+        std::copy(segment.samples.begin(), segment.samples.end(), thePulse.begin() + segment.start);
+        unsigned long end = segment.end();
+        thePulse.addPhotonInterval(segment.start, (end > segment.start + 20 ? end - 20 : segment.start));
+    }
+}
@@ -0,0 +1,222 @@
+//
+//  Service.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "TStopwatch.h"
+
+#include "Service.hpp"
+
+namespace
+{
+// Largest request that is read [bytes]
+const size_t kMaxRequest = 1 << 20;
+
+std::string readRequest(const int& connection)
+{
+    // Read up to an empty line or the end of the stream
+    std::string request;
+    char buffer[4096];
+    while (request.size() < kMaxRequest && request.find("\n\n") == std::string::npos)
+    {
+        ssize_t n = read(connection, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        request.append(buffer, n);
+    }
+    return request.substr(0, request.find("\n\n"));
+}
+
+void writeReply(const int& connection, const std::string& reply)
+{
+    size_t written = 0;
+    while (written < reply.size())
+    {
+        ssize_t n = send(connection, reply.data() + written, reply.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        written += n;
+    }
+}
+}
+
+Service::Service(const std::string& socketPath, Runner theRunner)
+    : fSocketPath(socketPath)
+    , fRunner(theRunner)
+    , fSocket(-1)
+    , fStop(false)
+{
+    /**
+     * Constructor for Service. Creates the socket at socketPath, replacing a
+     * socket left there by a service that was stopped. Throws if the socket
+     * cannot be created.
+     */
+    sockaddr_un theAddress;
+    std::memset(&theAddress, 0, sizeof(theAddress));
+    theAddress.sun_family = AF_UNIX;
+    if (fSocketPath.empty() || fSocketPath.size() >= sizeof(theAddress.sun_path))
+    {
+        throw std::runtime_error("Service: Invalid socket path " + fSocketPath);
+    }
+    std::strncpy(theAddress.sun_path, fSocketPath.c_str(), sizeof(theAddress.sun_path) - 1);
+
+    struct stat theStat;
+    if (lstat(fSocketPath.c_str(), &theStat) == 0)
+    {
+        if (!S_ISSOCK(theStat.st_mode))
+        {
+            throw std::runtime_error("Service: " + fSocketPath + " exists and is not a socket");
+        }
+        unlink(fSocketPath.c_str());
+    }
+
+    fSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fSocket < 0)
+    {
+        throw std::runtime_error(std::string("Service: Cannot create socket: ") + std::strerror(errno));
+    }
+    mode_t oldMask = umask(0077);
+    int bound = bind(fSocket, (sockaddr*)&theAddress, sizeof(theAddress));
+    umask(oldMask);
+    if (bound < 0 || listen(fSocket, 16) < 0)
+    {
+        std::string error = std::strerror(errno);
+        close(fSocket);
+        fSocket = -1;
+        throw std::runtime_error("Service: Cannot listen on " + fSocketPath + ": " + error);
+    }
+}
+
+Service::~Service()
+{
+    /**
+     * Destructor for Service. Closes and removes the socket.
+     */
+    if (fSocket >= 0)
+    {
+        close(fSocket);
+        unlink(fSocketPath.c_str());
+    }
+}
+
+void Service::run()
+{
+    /**
+     * Accept connections and run their jobs until a shutdown request.
+     */
+    std::cout << "Serving on " << fSocketPath << std::endl;
+    while (!fStop)
+    {
+        int connection = accept(fSocket, nullptr, nullptr);
+        if (connection < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("Service: Cannot accept connection: ") + std::strerror(errno));
+        }
+        writeReply(connection, handle(readRequest(connection)) + "\n");
+        close(connection);
+    }
+    std::cout << "Service stopped" << std::endl;
+}
+
+Service::Job Service::parseRequest(const std::string& request)
+{
+    /**
+     * Returns the job of a request. Throws if a line is not understood or
+     * there is no input file.
+     */
+    Job theJob;
+    std::istringstream theRequest(request);
+    std::string line;
+    while (std::getline(theRequest, line))
+    {
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+        std::istringstream theLine(line);
+        std::string field;
+        if (!(theLine >> field))
+            continue;
+
+        std::string value;
+        std::getline(theLine >> std::ws, value);
+        if (value.empty())
+            throw std::runtime_error("No value for " + field);
+        if (field == "input")
+            theJob.input_files.push_back(value);
+        else if (field == "outDir")
+            theJob.outDir = value;
+        else if (field == "events")
+            theJob.events = value;
+        else if (field == "set")
+        {
+            std::istringstream theSetting(value);
+            std::string setting;
+            std::string settingValue;
+            theSetting >> setting;
+            std::getline(theSetting >> std::ws, settingValue);
+            if (settingValue.empty())
+                throw std::runtime_error("No value for setting " + setting);
+            theJob.overrides.push_back(std::make_pair(setting, settingValue));
+        }
+        else
+            throw std::runtime_error("Unknown field " + field);
+    }
+    if (theJob.input_files.empty())
+        throw std::runtime_error("No input file");
+    return theJob;
+}
+
+std::string Service::handle(const std::string& request)
+{
+    /**
+     * Run the job of a request and return the reply, without the newline.
+     */
+    std::string trimmed = request;
+    trimmed.erase(0, trimmed.find_first_not_of(" \t\r\n"));
+    trimmed.erase(trimmed.find_last_not_of(" \t\r\n") + 1);
+    if (trimmed == "shutdown")
+    {
+        fStop = true;
+        return "OK shutdown";
+    }
+
+    TStopwatch timer;
+    timer.Start();
+    try
+    {
+        std::string outputFile = fRunner(parseRequest(request));
+        timer.Stop();
+        std::ostringstream reply;
+        reply << "OK " << timer.RealTime() << " " << timer.CpuTime() << " " << outputFile;
+        return reply.str();
+    }
+    catch (const std::exception& e)
+    {
+        std::string message = e.what();
+        for (char& c : message)
+        {
+            if (c == '\n')
+                c = ' ';
+        }
+        std::cout << "ERROR: Service job failed: " << message << std::endl;
+        return "ERROR " + message;
+    }
+}
@@ -0,0 +1,72 @@
+//
+//  SlicedPulse.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <algorithm>
+
+#include "SlicedPulse.hpp"
+
+SlicedPulse::SlicedPulse() : fLength(0), fWindowStart(0)
+{
+    /**
+     * Constructor for SlicedPulse.
+     */
+}
+
+SlicedPulse::~SlicedPulse()
+{
+    /**
+     * Destructor for SlicedPulse.
+     */
+}
+
+void SlicedPulse::reset(const unsigned long& length)
+{
+    /**
+     * Start a new pulse of the given length with an empty window at sample
+     * 0 and no photon intervals.
+     */
+    clear();
+    clearPhotonIntervals();
+    fLength = length;
+    fWindowStart = 0;
+}
+
+unsigned long SlicedPulse::getLength() const
+{
+    return fLength;
+}
+
+unsigned long SlicedPulse::getWindowStart() const
+{
+    return fWindowStart;
+}
+
+unsigned long SlicedPulse::getWindowEnd() const
+{
+    return fWindowStart + size();
+}
+
+void SlicedPulse::extendWindow(const unsigned long& end)
+{
+    /**
+     * Grow the window with zeros up to sample end (exclusive).
+     */
+    if (end > getWindowEnd())
+        resize(end - fWindowStart, 0.0);
+}
+
+void SlicedPulse::discardBefore(const unsigned long& start)
+{
+    /**
+     * Drop the samples before start from the window.
+     */
+    unsigned long n = std::min(start, getWindowEnd());
+    if (n <= fWindowStart)
+        return;
+    erase(begin(), begin() + (n - fWindowStart));
+    fWindowStart = n;
+}
@@ -0,0 +1,261 @@
+//
+//  Timeline.cpp
+//  devices
+//
+//  Copyright © 2026 LZOxford. All rights reserved.
+//
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "Timeline.hpp"
+#include "Config.hpp"
+
+namespace
+{
+const unsigned long kMinBufferSamples = 1024;
+
+void offsetPODs(PODArena& theArena, const size_t& first, const unsigned long long& offset)
+{
+    // PODContainer gives start times within the island
+    for (size_t i = first; i < theArena.size(); ++i)
+        theArena.at(i).start += offset;
+}
+}
+
+Timeline::Timeline(std::shared_ptr<Digitizer> theDigitizer)
+    : fDigitizer(theDigitizer)
+    , fHorizon(0)
+{
+    /**
+     * Constructor for Timeline. An island starts 1024 ns before its response,
+     * as the pulse of an event does, so that the rolling baseline of the POD
+     * trigger has settled. It is streamed until a POD that starts at the end
+     * of the response would be complete.
+     */
+    unsigned long long samplingRate = std::stoull(global::config->getConfig("SmplRate")); //[ns]
+    unsigned long long preTrigger = std::stoull(global::config->getConfig("PreTrigger"));
+    unsigned long long postTrigger = std::stoull(global::config->getConfig("PostTrigger"));
+    unsigned long long interPod = std::stoull(global::config->getConfig("IntrPodTime"));
+    unsigned long long threshTimer = std::stoull(global::config->getConfig("ThreshTimer"));
+    fLead = std::max(preTrigger, 1024 / samplingRate);
+    fTail = preTrigger + postTrigger + interPod + threshTimer + 1;
+}
+
+Timeline::~Timeline()
+{
+    /**
+     * Destructor for Timeline.
+     */
+}
+
+void Timeline::addResponse(const unsigned int& pmtChannel, const unsigned long long& start,
+    const std::vector<double>& theLGResponse, const std::vector<double>& theHGResponse)
+{
+    /**
+     * Add the LG and HG responses [mV] of a channel to an event whose first
+     * sample is at start. Only the part from the first to the last non-zero
+     * sample is kept. start must not be before the horizon.
+     */
+    if (start < fHorizon)
+        throw std::runtime_error("Timeline: response added before the horizon");
+
+    const std::vector<double>* responses[2] = { &theLGResponse, &theHGResponse };
+    size_t n = std::max(theLGResponse.size(), theHGResponse.size());
+    size_t first = n;
+    size_t last = 0;
+    for (unsigned int g = 0; g < 2; ++g)
+    {
+        const std::vector<double>& theResponse = *responses[g];
+        for (size_t i = 0; i < std::min(first, theResponse.size()); ++i)
+            if (theResponse[i] != 0)
+            {
+                first = i;
+                break;
+            }
+        for (size_t i = theResponse.size(); i > std::max(last, first); --i)
+            if (theResponse[i - 1] != 0)
+            {
+                last = i;
+                break;
+            }
+    }
+    if (first >= last)
+        return;
+
+    // An island that is not streamed yet is started earlier if a later
+    // event has an earlier response.
+    unsigned long long islandStart = std::max(fHorizon, (start + first > fLead ? start + first - fLead : 0));
+    auto it = fIslands.find(pmtChannel);
+    Island& theIsland = (it != fIslands.end() ? *it->second : openIsland(pmtChannel, islandStart));
+    if (islandStart < theIsland.start)
+    {
+        reserve(theIsland, islandStart, start + last);
+        theIsland.start = islandStart;
+        theIsland.next = islandStart;
+    }
+    else
+        reserve(theIsland, theIsland.next, start + last);
+    for (unsigned int g = 0; g < 2; ++g)
+    {
+        const std::vector<double>& theResponse = *responses[g];
+        for (size_t i = first; i < std::min(last, theResponse.size()); ++i)
+            theIsland.response[g][start + i] += theResponse[i];
+    }
+    theIsland.end = std::max(theIsland.end, start + last);
+}
+
+void Timeline::advance(const unsigned long long& horizon, PODArena& theLGPODs, PODArena& theHGPODs)
+{
+    /**
+     * Make the samples before horizon final: stream them into the PODs and
+     * close the islands that have ended. The complete PODs are added to the
+     * arenas.
+     */
+    if (horizon <= fHorizon)
+        return;
+
+    PODArena* theArenas[2] = { &theLGPODs, &theHGPODs };
+    for (auto it = fIslands.begin(); it != fIslands.end();)
+    {
+        Island& theIsland = *it->second;
+        if (horizon >= theIsland.end + fTail)
+        {
+            close(it->first, theIsland, theArenas);
+            fSpareIslands.push_back(std::move(it->second));
+            it = fIslands.erase(it);
+        }
+        else
+        {
+            stream(it->first, theIsland, horizon, theArenas);
+            ++it;
+        }
+    }
+    fHorizon = horizon;
+}
+
+void Timeline::finish(PODArena& theLGPODs, PODArena& theHGPODs)
+{
+    /**
+     * Close all islands, at the end of the acquisition.
+     */
+    unsigned long long horizon = fHorizon;
+    for (auto& theIsland : fIslands)
+        horizon = std::max(horizon, theIsland.second->end + fTail);
+    advance(horizon, theLGPODs, theHGPODs);
+}
+
+unsigned long long Timeline::getHorizon() const
+{
+    return fHorizon;
+}
+
+size_t Timeline::getNIslands() const
+{
+    return fIslands.size();
+}
+
+Timeline::Island& Timeline::openIsland(const unsigned int& pmtChannel, const unsigned long long& start)
+{
+    /**
+     * Open an island for a channel from start, reusing the buffers of a closed
+     * island if there is one. Their samples are zero.
+     */
+    std::unique_ptr<Island> theIsland;
+    if (fSpareIslands.empty())
+    {
+        theIsland.reset(new Island());
+        for (unsigned int g = 0; g < 2; ++g)
+            theIsland->response[g].init(kMinBufferSamples);
+    }
+    else
+    {
+        theIsland = std::move(fSpareIslands.back());
+        fSpareIslands.pop_back();
+    }
+
+    theIsland->start = start;
+    theIsland->next = theIsland->start;
+    theIsland->end = theIsland->start;
+    for (unsigned int g = 0; g < 2; ++g)
+    {
+        theIsland->pods[g].reset(new PODContainer());
+        theIsland->pods[g]->setBaseline(fDigitizer->getBaseline(), fDigitizer->getBaselineSigma(pmtChannel));
+        theIsland->pods[g]->startPODContainer(pmtChannel, 0, 0, std::numeric_limits<unsigned long>::max(),
+            std::shared_ptr<MCTruth>(), (g == 0 ? "LG" : "HG"));
+    }
+
+    Island& theOpenIsland = *theIsland;
+    fIslands[pmtChannel] = std::move(theIsland);
+    return theOpenIsland;
+}
+
+void Timeline::reserve(Island& theIsland, const unsigned long long& first, const unsigned long long& end)
+{
+    /**
+     * Grow the buffers of the island, if needed, to hold the samples from
+     * first, which is not after the first sample not streamed yet, to end.
+     */
+    unsigned long long needed = std::max(end, theIsland.end) - first;
+    unsigned long size = theIsland.response[0].size();
+    if (needed <= size)
+        return;
+    while (size < needed)
+        size *= 2;
+
+    for (unsigned int g = 0; g < 2; ++g)
+    {
+        Buffer<double> theBuffer;
+        theBuffer.init(size);
+        for (unsigned long long i = theIsland.next; i < theIsland.end; ++i)
+            theBuffer[i] = theIsland.response[g][i];
+        std::swap(theIsland.response[g], theBuffer);
+    }
+}
+
+void Timeline::stream(const unsigned int& pmtChannel, Island& theIsland, const unsigned long long& last,
+    PODArena* theArenas[2])
+{
+    /**
+     * Digitise the samples of the island up to last and add them to its PODs.
+     * The buffers are zeroed behind the samples that are streamed.
+     */
+    if (last <= theIsland.next)
+        return;
+
+    size_t n = last - theIsland.next;
+    for (unsigned int g = 0; g < 2; ++g)
+    {
+        fBlock.resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double& theSample = theIsland.response[g][theIsland.next + i];
+            fBlock[i] = theSample;
+            theSample = 0;
+        }
+        fDigitizer->digitizeSamples(pmtChannel, fBlock.data(), n, fDigitized);
+
+        size_t first = theArenas[g]->size();
+        theIsland.pods[g]->setArena(theArenas[g]);
+        theIsland.pods[g]->addPODContainerSamples(fDigitized);
+        offsetPODs(*theArenas[g], first, theIsland.start);
+    }
+    theIsland.next = last;
+}
+
+void Timeline::close(const unsigned int& pmtChannel, Island& theIsland, PODArena* theArenas[2])
+{
+    /**
+     * Stream the rest of the island and cut its last PODs.
+     */
+    stream(pmtChannel, theIsland, theIsland.end + fTail, theArenas);
+    for (unsigned int g = 0; g < 2; ++g)
+    {
+        size_t first = theArenas[g]->size();
+        theIsland.pods[g]->setArena(theArenas[g]);
+        theIsland.pods[g]->finishPODContainer();
+        offsetPODs(*theArenas[g], first, theIsland.start);
+        theIsland.pods[g].reset();
+    }
+}
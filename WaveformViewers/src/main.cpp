@@ -2,8 +2,11 @@
 #include <iostream>
 
 #include "RunControl.hpp"
+#include "Service.hpp"
 
 void print_timer(TStopwatch& timer);
+int serve(const std::string& socketPath, DBInterfaceFactory<double>& pmtParamsFactory,
+    DeviceVectors& electronics, unsigned int firstDoubleGainStage, std::string& derRandomSeed, bool autoSeed);
 
 /**
  * Configure all settings for run.
@@ -31,23 +34,19 @@ int main(int argc, char** argv)
     // Read configuration file
     global::config = global::create_default_config();
 
-    DERSummary dersummary;
-    EBSummary ebsummary;
-    EBGlobal ebGlobal;
-
     DBInterfaceFactory<double> pmtParamsFactory;
     std::shared_ptr<DBInterface<double>> pmtCSVParams;
-    DERSummary* theDERSummary = &dersummary;
-
-    EBSummary* theEBSummary = &ebsummary;
-    EBGlobal* theGlobalEB = &ebGlobal;
 
     std::vector<std::string> input_files;
     std::string inFilename;
+    std::string flatOutput;
+    std::string batchList;
+    std::string serveSocket;
 
     try
     {
-        RunControl::parse_user_inputs(argc, argv, input_files, inFilename, global::config);
+        RunControl::parse_user_inputs(
+            argc, argv, input_files, inFilename, flatOutput, batchList, serveSocket, global::config);
     }
     catch (std::runtime_error& e)
     {
@@ -55,23 +54,15 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    format::revision formatVersion = format::revision::ROOTvMDC2;
-    Input* input = InputFactory::getInput(formatVersion);
-
-    Output* output = NULL;
-
-    std::string fileRandomSeed = "";
-    unsigned long posixTime = 0;
-    unsigned long realPosixTime = 0;
-    std::string localTime = "";
     std::string derRandomSeed = "UNKNOWN";
-    int dataCollectors = 0;
-    int channelsPerDDC32 = 0;
-    int samplingRate_ns = 0;
-    int ddc32Boards = 0;
-    bool outputIsBinary = false;
-    unsigned int runNumber = 0;
+    bool autoSeed = (global::config->getConfig("RandomNumberSeed") == "AUTO");
+    std::string outDirectory = global::config->getConfig("outDir");
+    std::vector<RunControl::BatchJob> theJobs;
+    unsigned int firstDoubleGainStage = 0;
+    DeviceVectors electronics;
 
+    // Setup that only depends on the configuration is done once, and is
+    // shared by all input files of a batch or jobs of the service.
     try
     {
         RunControl::set_number_of_threads(global::config);
@@ -79,25 +70,22 @@ int main(int argc, char** argv)
         RunControl::set_pmt_parameters(pmtParamsFactory, pmtCSVParams, global::config);
         //    	RunControl::set_trigger_parameters();
         RunControl::set_data_collector_events(global::config);
-        RunControl::check_file_permissions(global::config);
-        RunControl::setup_input(input, input_files);
-        RunControl::check_pmts_and_events(input, global::config);
-        RunControl::setup_output(output, formatVersion, outputIsBinary, global::config);
-        RunControl::setup_time_stamp(output, realPosixTime, posixTime, localTime, global::config);
-        RunControl::setup_summary(input, output, *theDERSummary, input_files, posixTime, realPosixTime, fileRandomSeed,
-            derRandomSeed, localTime, *theGlobalEB, dataCollectors, channelsPerDDC32, ddc32Boards, samplingRate_ns,
-            runNumber, global::config);
-        RunControl::print_user_info(*theDERSummary);
-        RunControl::user_check(*theDERSummary, global::config);
-
-        std::cout << std::endl;
-        std::cout << std::endl;
-
-        RunControl::setup_pmt_start_int(input);
-
-        output->doInitInputVariables(input);
-
-        RunControl::write_summary_objects(input, output, theDERSummary, theEBSummary, theGlobalEB);
+        if (!flatOutput.empty())
+        {
+            Input* input = InputFactory::getInput(RunControl::get_input_format(input_files));
+            RunControl::check_file_permissions(global::config);
+            RunControl::setup_input(input, input_files);
+            RunControl::check_pmts_and_events(input, global::config);
+            RunControl::convert_to_flat_photons(input, flatOutput);
+            input->Close();
+            delete input;
+            return 0;
+        }
+        if (!batchList.empty())
+        {
+            theJobs = RunControl::read_batch_list(batchList);
+        }
+        electronics = RunControl::setup_analogue_electronics(firstDoubleGainStage, global::config);
     }
     catch (const std::exception& e)
     {
@@ -105,29 +93,72 @@ int main(int argc, char** argv)
         return 1;
     }
 
-    //----------------------------------------------------
-    // Recreate the Data Collectors on each event
-    // Currently uses PosixTime. Will become (PosixTime) + (duration [samples = 10 ns] of previous event)
-    DDC32 theDCs(dataCollectors, channelsPerDDC32, posixTime);
-    theDCs.setSamplingRate(samplingRate_ns);
+    if (!serveSocket.empty())
+    {
+        return serve(serveSocket, pmtParamsFactory, electronics, firstDoubleGainStage, derRandomSeed, autoSeed);
+    }
 
-    RunControl::acquire_and_process_data(input, output, theDCs, theEBSummary, global::config);
+    if (theJobs.empty())
+    {
+        try
+        {
+            RunControl::run_input_files(input_files, derRandomSeed, electronics, firstDoubleGainStage, timer,
+                global::config);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
 
-    output->doWriteTruthTree();
+        timer.Stop();
 
-    output->doWriteTime(timer.RealTime(), timer.CpuTime());
-    output->CloseFile();
+        print_timer(timer);
 
-    delete output;
+        return 0;
+    }
 
-    input->Close();
-    delete input;
+    // Batch mode: every input file gets its own output, with the output
+    // directory of its line or the outDir setting. A fixed seed is set again
+    // for every file, so that each output is as if DER was run on its own.
+    // The digitizer draws its noise banks when it is built, so it is built
+    // again after the seed.
+    unsigned long nFailed = 0;
+    for (unsigned long i = 0; i < theJobs.size(); i++)
+    {
+        RunControl::BatchJob& theJob = theJobs[i];
+        std::cout << std::endl;
+        std::cout << "Batch " << (i + 1) << "/" << theJobs.size() << ": " << theJob.input_files[0] << std::endl;
+        TStopwatch fileTimer;
+        fileTimer.Start();
+        try
+        {
+            global::config->CLISet("outDir", (theJob.outDir.empty() ? outDirectory : theJob.outDir));
+            if (i > 0 && !autoSeed)
+            {
+                RunControl::set_random_number_seeds(derRandomSeed, global::config);
+                RunControl::setup_noise_devices(electronics, global::config);
+            }
+            RunControl::run_input_files(theJob.input_files, derRandomSeed, electronics, firstDoubleGainStage,
+                fileTimer, global::config);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            std::cout << "ERROR: Batch input " << theJob.input_files[0] << " failed, continuing with the next"
+                      << std::endl;
+            ++nFailed;
+        }
+    }
+    std::cout << std::endl;
+    std::cout << "Batch: " << (theJobs.size() - nFailed) << " of " << theJobs.size() << " input files processed"
+              << std::endl;
 
     timer.Stop();
 
     print_timer(timer);
 
-    return 0;
+    return (nFailed == 0 ? 0 : 1);
 }
 
 void print_timer(TStopwatch& timer)
@@ -140,3 +171,102 @@ void print_timer(TStopwatch& timer)
     std::cout << "Closing..." << std::endl;
     std::cout << "Finished." << std::endl;
 }
+
+int serve(const std::string& socketPath, DBInterfaceFactory<double>& pmtParamsFactory,
+    DeviceVectors& electronics, unsigned int firstDoubleGainStage, std::string& derRandomSeed, bool autoSeed)
+{
+    /**
+     * Run the jobs sent to socketPath with the resident PMT parameters and
+     * electronics, until a shutdown request.
+     *
+     * The settings of a job are changed for that job only. The electronics
+     * are built again for a job that changes settings, as the devices read
+     * them when they are made, and so are the PMT parameters if a setting
+     * they are made from is changed. A job that sets the seed otherwise gets
+     * a new digitizer, whose noise banks are drawn from that seed. Returns
+     * 0, or 1 if the service cannot be started.
+     */
+    const std::set<std::string> pmtSettings = { "PMTParamsPath", "TPCTopPMTs", "TPCBotPMTs", "SkinTPMTs",
+        "SkinBPMTs", "OuterPMTs", "PMTQE", "CE", "2PheProb", "DarkRate", "BaccQEFactor" };
+    std::string outDirectory = global::config->getConfig("outDir");
+
+    Service::Runner runJob = [&](const Service::Job& theJob) {
+        std::vector<std::pair<std::string, std::string>> theSettings = theJob.overrides;
+        theSettings.push_back(std::make_pair("outDir", (theJob.outDir.empty() ? outDirectory : theJob.outDir)));
+        if (!theJob.events.empty())
+        {
+            theSettings.push_back(std::make_pair("ProcessAllEvts", "false"));
+            theSettings.push_back(std::make_pair("SelectedEvents", theJob.events));
+        }
+
+        // The settings are put back as they were after the job
+        std::vector<std::pair<std::string, std::string>> theSaved;
+        std::shared_ptr<DBInterface<double>> theParams = PMT::getParamPointer();
+        auto restore = [&]() {
+            for (auto it = theSaved.rbegin(); it != theSaved.rend(); ++it)
+                global::config->CLISet(it->first, it->second);
+            PMT::setParamPointer(theParams);
+        };
+
+        try
+        {
+            bool newPMTParams = false;
+            bool newSeed = !autoSeed;
+            for (const auto& theSetting : theSettings)
+            {
+                if (!global::config->hasConfig(theSetting.first))
+                    throw std::runtime_error("Unknown setting " + theSetting.first);
+                theSaved.push_back(std::make_pair(theSetting.first, global::config->getConfig(theSetting.first)));
+                global::config->CLISet(theSetting.first, theSetting.second);
+                newPMTParams = newPMTParams || pmtSettings.count(theSetting.first);
+                newSeed = newSeed || theSetting.first == "RandomNumberSeed";
+            }
+
+            std::string jobRandomSeed = derRandomSeed;
+            if (newSeed)
+            {
+                RunControl::set_random_number_seeds(jobRandomSeed, global::config);
+            }
+            std::shared_ptr<DBInterface<double>> pmtCSVParams;
+            if (newPMTParams)
+            {
+                RunControl::set_pmt_parameters(pmtParamsFactory, pmtCSVParams, global::config);
+            }
+            DeviceVectors jobElectronics = electronics;
+            unsigned int jobFirstDoubleGainStage = firstDoubleGainStage;
+            if (!theJob.overrides.empty())
+            {
+                jobElectronics = RunControl::setup_analogue_electronics(jobFirstDoubleGainStage, global::config);
+            }
+            else if (newSeed)
+            {
+                RunControl::setup_noise_devices(jobElectronics, global::config);
+            }
+
+            std::vector<std::string> input_files = theJob.input_files;
+            TStopwatch jobTimer;
+            jobTimer.Start();
+            std::string outFileName = RunControl::run_input_files(input_files, jobRandomSeed, jobElectronics,
+                jobFirstDoubleGainStage, jobTimer, global::config);
+            restore();
+            return outFileName;
+        }
+        catch (...)
+        {
+            restore();
+            throw;
+        }
+    };
+
+    try
+    {
+        Service theService(socketPath, runJob);
+        theService.run();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}